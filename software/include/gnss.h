@@ -27,18 +27,34 @@ typedef struct {
 
 	uint16_t speed_centi_ms;
 	uint16_t course_centi_deg;
+	uint32_t last_velocity_tick; /* RMC with a valid fix; 0 if speed/course were never reported. */
 
-	uint32_t last_fix_tick;
+	uint32_t last_fix_tick; /* When the current fix epoch was first reported. */
+	uint32_t fix_time_ms;   /* UTC time of day of the current fix epoch. */
+	uint32_t fix_epoch;     /* Bumped once per epoch: GGA and RMC with the same UTC time share one. */
 
 	uint32_t nmea_sentences;
 	uint32_t nmea_checksum_errors;
+
+	uint32_t baudrate;
+	uint8_t baud_switch_failures;
+	uint16_t autobaud_corrections; /* Times auto-baud found the module at another rate. */
 } GnssModuleState;
 
 void Gnss_Init(uint32_t baudrate);
+bool Gnss_RequestBaudrate(uint32_t baudrate);
+bool Gnss_BaudSwitchPending(void);
 void Gnss_Task(void *argument);
 const GnssModuleState *Gnss_GetModules(void);
 const GnssModuleState *Gnss_GetModule(uint8_t module_index);
 
+/*
+ * Modules being received and fused, bit n-1 for module #n. Set takes effect on Gnss_Task's next
+ * pass and overrides both GNSS_ACTIVE_MODULES and the boot-time silence detection.
+ */
+void Gnss_SetActiveModules(uint8_t mask);
+uint8_t Gnss_GetActiveModules(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Local tangent plane shared by the fusion code: east/north centimetres from one anchor point.
+ * The longitude scale (cos of the anchor latitude) is computed once per anchor, so conversions
+ * are a multiply and a shift. Not thread-safe; the fusion task is the only user.
+ */
+
+/* The anchor moves to the current solution once that is further away than this. */
+#ifndef GNSS_ENU_REANCHOR_CM
+#define GNSS_ENU_REANCHOR_CM 100000
+#endif
+
+void GnssEnu_Init(void);
+bool GnssEnu_HasAnchor(void);
+void GnssEnu_SetAnchor(int32_t lat_e7, int32_t lon_e7);
+
+/* Re-anchor at the given point if there is no anchor or it is beyond GNSS_ENU_REANCHOR_CM. */
+bool GnssEnu_Follow(int32_t lat_e7, int32_t lon_e7);
+
+/* Longitude in 1e-7 degrees brought into [-180, 180), and the shortest signed difference. */
+int32_t GnssEnu_WrapLon(int64_t lon_e7);
+int32_t GnssEnu_LonDelta(int32_t lon_e7, int32_t ref_lon_e7);
+
+void GnssEnu_ToLocal(int32_t lat_e7, int32_t lon_e7, int32_t *east_cm, int32_t *north_cm);
+void GnssEnu_FromLocal(int32_t east_cm, int32_t north_cm, int32_t *lat_e7, int32_t *lon_e7);
+
+/* Move a point by a local east/north displacement, with the anchor's scale factors. */
+void GnssEnu_Offset(int32_t *lat_e7, int32_t *lon_e7, int32_t east_cm, int32_t north_cm);
+
+/* Ground speed and course over ground (0 = north, clockwise) as east/north components. */
+void GnssEnu_VelocityFromCourse(uint16_t speed_centi_ms, uint16_t course_centi_deg, int32_t *east_cms,
+                                int32_t *north_cms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -14,6 +14,17 @@ typedef enum {
 	GNSS_FUSION_INTERFERENCE = 3,
 } GnssFusionStatus;
 
+/*
+ * Outlier handling: a hard gate around the median with flat 1/hdop^2 weights, or iteratively
+ * reweighted least squares with Huber (never rejects, down-weights beyond its knee) or Tukey
+ * biweight (weight falls smoothly to zero at the gate threshold) weights.
+ */
+typedef enum {
+	GNSS_FUSION_MODE_GATE = 0,
+	GNSS_FUSION_MODE_HUBER = 1,
+	GNSS_FUSION_MODE_TUKEY = 2,
+} GnssFusionMode;
+
 typedef struct {
 	bool has_fix;
 	GnssFusionStatus status;
@@ -22,20 +33,63 @@ typedef struct {
 	int32_t lon_e7;
 	int32_t alt_cm;
 
+	/* Fused RMC ground velocity; valid when velocity_modules > 0. */
+	int32_t vel_e_cms;
+	int32_t vel_n_cms;
+	uint8_t velocity_modules;
+
 	uint8_t used_modules;
 	uint8_t rejected_modules;
+	uint8_t alt_rejected_modules; /* Horizontally used, but left out of alt_cm by the vertical pass. */
 
 	uint16_t max_residual_cm;
 	uint16_t avg_hdop_centi;
 
+	/*
+	 * 1-sigma accuracy of the published fix: east/north covariance (track variance plus the
+	 * common-mode floor, or the epoch spread if larger), horizontal DRMS (sqrt of the trace),
+	 * vertical sigma, and the radius holding 95% of horizontal errors.
+	 */
+	uint32_t var_east_cm2;
+	uint32_t var_north_cm2;
+	int32_t cov_en_cm2;
+	uint16_t std_horizontal_cm;
+	uint16_t std_up_cm;
+	uint16_t cep95_cm;
+
 	uint32_t last_update_tick;
 } GnssFusionResult;
 
+/* A module's estimated bias in the local east/north/up frame, subtracted from its fixes. */
+typedef struct {
+	int32_t east_cm;
+	int32_t north_cm;
+	int32_t up_cm;
+} GnssFusionBias;
+
+/* Fusion runtime, cumulative since GnssFusion_Init(). */
+typedef struct {
+	uint32_t runs;
+	uint32_t cycles_last; /* CPU cycles of the last fusion pass, from DWT->CYCCNT. */
+	uint32_t cycles_max;
+
+	/* Time alignment in the last pass: oldest fix propagated and the largest shift applied. */
+	uint32_t align_max_age_ms;
+	uint32_t align_max_cm;
+	uint8_t align_track_velocity; /* Fixes propagated with the track velocity, lacking their own. */
+
+	uint8_t irls_iterations; /* Robust modes: reweighting iterations in the last pass. */
+} GnssFusionDiagnostics;
+
 void GnssFusion_Init(void);
 void GnssFusion_Task(void *argument);
 bool GnssFusion_GetResult(GnssFusionResult *out);
 bool GnssFusion_GetResultFromISR(GnssFusionResult *out);
 bool GnssFusion_GetModuleFaultScore(uint8_t module_index, uint16_t *out_score);
+bool GnssFusion_GetDiagnostics(GnssFusionDiagnostics *out);
+bool GnssFusion_GetModuleBias(uint8_t module_index, GnssFusionBias *out);
+void GnssFusion_SetMode(GnssFusionMode mode);
+GnssFusionMode GnssFusion_GetMode(void);
 
 #ifdef __cplusplus
 }
@@ -2,6 +2,7 @@
 
 #include "stm32f1xx_hal.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -20,20 +21,98 @@ typedef struct {
 	uint16_t rx_pin;
 
 	USART_TypeDef *uart_instance; /* NULL when not on a HW USART pin pair. */
+
+	/* Software channels only: timer input capture on the RX pin, NULL to use the sampled decoder. */
+	TIM_TypeDef *capture_timer;
+	uint8_t capture_channel; /* 1..4 */
 } GnssUartPins;
 
 extern const GnssUartPins kGnssUartPins[GNSS_MODULE_COUNT];
 
+/*
+ * Receive-path counters for one module, cumulative since boot. Software channels report a start
+ * bit that is high again at mid-bit as noise; the USART reports its own NE/FE/ORE flags.
+ */
+typedef struct {
+	uint32_t bytes_received;
+	uint32_t ring_drops;      /* Bytes lost to a full receive ring. */
+	uint16_t ring_high_water; /* Highest ring fill level seen, in bytes. */
+	uint32_t framing_errors;
+	uint32_t noise_errors;
+	uint32_t overruns;    /* USART only. */
+	uint32_t rx_restarts; /* USART only: DMA reception re-armed after a transfer error or stall. */
+	/*
+	 * Longest receive interrupt in CPU cycles: the USART/DMA interrupts on USART channels, the
+	 * shared decode interrupt on sampled software channels. Capture channels report 0.
+	 */
+	uint32_t isr_cycles_max;
+	/* Sampled software channels only: highest CPU share of the decode interrupt, per mille. */
+	uint32_t isr_load_permille_max;
+} GnssUartStats;
+
 void GnssUart_GpioInit(void);
 void GnssUart_HardwareUartsInit(uint32_t baudrate);
 UART_HandleTypeDef *GnssUart_GetHardwareHandle(uint8_t module_index);
 
 void GnssUart_StartHardwareRx(void);
 size_t GnssUart_ReadBytes(uint8_t module_index, uint8_t *dst, size_t max_len);
-void GnssUart_IrqHandler(USART_TypeDef *instance);
+
+/*
+ * Zero-copy read: Peek returns the contiguous run of unread bytes starting `offset` bytes in (a
+ * wrapped ring takes two calls) and Consume releases `len` bytes once parsed. Data stays valid
+ * until consumed.
+ */
+size_t GnssUart_Peek(uint8_t module_index, size_t offset, const uint8_t **data);
+void GnssUart_Consume(uint8_t module_index, size_t len);
+
+/*
+ * Changes whenever a module's unread bytes are discarded (DMA restart, baud change, channel
+ * stop). Peek offsets held across a change no longer point into the data; check after Peek.
+ */
+uint8_t GnssUart_RxGeneration(uint8_t module_index);
+bool GnssUart_GetStats(uint8_t module_index, GnssUartStats *out);
+size_t GnssUart_Write(uint8_t module_index, const uint8_t *data, size_t len);
+bool GnssUart_TxBusy(uint8_t module_index);
+
+/*
+ * Hardware receive channels. Each USART and DMA vector passes its own channel, which indexes the
+ * receive descriptors directly.
+ */
+typedef enum {
+	GNSS_UART_RX_USART3 = 0, /* GNSS #1, DMA1 channel 3 */
+	GNSS_UART_RX_USART2 = 1, /* GNSS #2, DMA1 channel 6 */
+	GNSS_UART_RX_USART1 = 2, /* GNSS #3, DMA1 channel 5 */
+	GNSS_UART_RX_COUNT = 3,
+} GnssUartRxChannel;
+
+void GnssUart_IrqHandler(GnssUartRxChannel channel);
+void GnssUart_DmaIrqHandler(GnssUartRxChannel channel);
 
 void GnssUart_SoftUartInit(uint32_t baudrate);
+bool GnssUart_SetBaud(uint8_t module_index, uint32_t baudrate);
+uint32_t GnssUart_GetBaud(uint8_t module_index);
+/* Highest rate SetBaud accepts: GNSS_SOFT_UART_MAX_BAUD on sampled channels, else UINT32_MAX. */
+uint32_t GnssUart_MaxBaud(uint8_t module_index);
+
+/*
+ * Receive-path enable, bit n-1 for module #n (all set at boot). An inactive channel has its USART
+ * receiver and DMA, capture interrupt or sampled-decoder bit switched off and is skipped by reads.
+ * Call after GnssUart_StartHardwareRx() and GnssUart_SoftUartInit().
+ */
+void GnssUart_SetActiveMask(uint8_t mask);
+uint8_t GnssUart_GetActiveMask(void);
+
+/*
+ * Auto-baud detection: start measuring a channel's line rate, then call Poll from the reading
+ * task until it returns true. *baudrate is the detected standard rate, or 0 if none was found.
+ * The channel keeps its current rate; apply the result with GnssUart_SetBaud().
+ */
+bool GnssUart_AutoBaudStart(uint8_t module_index);
+bool GnssUart_AutoBaudPoll(uint8_t module_index, uint32_t *baudrate);
+void GnssUart_SoftDmaIrqHandler(void);
 void GnssUart_TimIrqHandler(void);
+void GnssUart_ExtiIrqHandler(void);
+void GnssUart_CaptureIrqHandler(TIM_TypeDef *timer);
 
 #ifdef __cplusplus
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -29,6 +30,7 @@ typedef struct {
 bool Nmea_ChecksumOk(const char *sentence);
 bool Nmea_ParseGga(const char *sentence, NmeaGga *out);
 bool Nmea_ParseRmc(const char *sentence, NmeaRmc *out);
+size_t Nmea_BuildSentence(const char *body, char *out, size_t out_len);
 
 #ifdef __cplusplus
 }
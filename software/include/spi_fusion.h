@@ -6,7 +6,7 @@
 extern "C" {
 #endif
 
-#define SPI_FUSION_PACKET_SIZE 32u
+#define SPI_FUSION_PACKET_SIZE 58u
 
 void SpiFusion_Init(void);
 void SpiFusion_SpiIrqHandler(void);
@@ -9,26 +9,104 @@
 #include "gnss_uart.h"
 #include "nmea.h"
 
+#ifndef GNSS_POLL_MS
+#define GNSS_POLL_MS 2u
+#endif
+
+/* Time allowed for a module to apply $PCAS01 after the command has left the TX pin. */
+#define BAUD_SWITCH_SETTLE_MS 100u
+/* Valid sentences required at the new rate before a switch counts as verified. */
+#define BAUD_SWITCH_VERIFY_SENTENCES 2u
+#define BAUD_SWITCH_VERIFY_TIMEOUT_MS 3000u
+
+/*
+ * A module without a valid sentence for this long has its channel rate re-detected, e.g. after a
+ * brownout reset it to its factory rate. Detections that find nothing back off up to the maximum.
+ */
+#define AUTOBAUD_SILENCE_MS 3000u
+#define AUTOBAUD_SILENCE_MAX_MS 60000u
+
+/*
+ * Boot-time detections in a row that must find neither a rate nor a valid sentence before a
+ * module is dropped. Edge stamps can be delayed by masked sections, so one failed probe is not
+ * proof of an empty slot.
+ */
+#define AUTOBAUD_BOOT_PROBES 3u
+
+/*
+ * Modules fitted on the board, bit n-1 for module #n; the others are never started. With
+ * GNSS_ACTIVE_AUTODETECT a fitted module whose line stays silent through AUTOBAUD_BOOT_PROBES
+ * boot-time rate detections is dropped as well. Gnss_SetActiveModules() overrides both at runtime.
+ */
+#ifndef GNSS_ACTIVE_MODULES
+#define GNSS_ACTIVE_MODULES 0xFFu
+#endif
+
+#ifndef GNSS_ACTIVE_AUTODETECT
+#define GNSS_ACTIVE_AUTODETECT 1
+#endif
+
+/* Longest sentence kept, without CR/LF; NMEA 0183 itself allows 80 characters. */
+#ifndef GNSS_LINE_MAX
+#define GNSS_LINE_MAX 95u
+#endif
+
+/*
+ * Sentences are assembled in the receive ring itself: `scanned` counts unread bytes already
+ * searched for '\n', and only a complete line is copied out, into the one shared line buffer.
+ * `generation` is the ring's discard count `scanned` was taken against.
+ */
 typedef struct {
-	char line[96];
-	uint16_t used;
-} LineBuffer;
+	uint16_t scanned;
+	uint8_t generation;
+} LineScan;
+
+typedef enum {
+	BAUD_SWITCH_IDLE = 0,
+	BAUD_SWITCH_PENDING = 1,  /* Command not yet sent. */
+	BAUD_SWITCH_COMMAND = 2,  /* $PCAS01 sent at the old rate, waiting for TX drain and settle. */
+	BAUD_SWITCH_VERIFY = 3,   /* Channel at the new rate, waiting for valid sentences. */
+	BAUD_SWITCH_ROLLBACK = 4, /* Revert command sent at the new rate, waiting for TX drain. */
+} BaudSwitchState;
+
+typedef struct {
+	BaudSwitchState state;
+	uint32_t from_baud;
+	uint32_t to_baud;
+	uint32_t since_tick;
+	uint32_t valid_at_switch;
+} BaudSwitch;
+
+typedef struct {
+	bool detecting;
+	uint32_t valid_seen;
+	uint32_t last_valid_tick;
+	uint32_t silence_ms;
+	uint8_t boot_failures;
+} AutoBaudWatch;
 
 static GnssModuleState modules[GNSS_MODULE_COUNT];
-static LineBuffer line_buffers[GNSS_MODULE_COUNT];
+static LineScan line_scans[GNSS_MODULE_COUNT];
+static char line_buffer[GNSS_LINE_MAX + 1u];
+static BaudSwitch baud_switches[GNSS_MODULE_COUNT];
+static AutoBaudWatch autobaud_watches[GNSS_MODULE_COUNT];
+static uint32_t target_baud;
 
-static GnssModuleState *module_by_index(uint8_t module_index) {
-	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
-		return NULL;
-	}
-	return &modules[module_index - 1];
+/* Active modules as applied by Gnss_Task, and the mask last requested from any task. */
+static uint8_t active_modules;
+static volatile uint8_t active_request;
+/* Modules still in their boot-time detection, dropped if it keeps finding no signal. */
+static uint8_t boot_probe;
+
+static bool module_active(uint8_t module_index) {
+	return (active_modules & (1u << (module_index - 1u))) != 0;
 }
 
-static LineBuffer *line_by_index(uint8_t module_index) {
+static GnssModuleState *module_by_index(uint8_t module_index) {
 	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
 		return NULL;
 	}
-	return &line_buffers[module_index - 1];
+	return &modules[module_index - 1];
 }
 
 const GnssModuleState *Gnss_GetModules(void) {
@@ -42,20 +120,43 @@ const GnssModuleState *Gnss_GetModule(uint8_t module_index) {
 void Gnss_Init(uint32_t baudrate) {
 	for (uint8_t i = 1; i <= GNSS_MODULE_COUNT; i++) {
 		GnssModuleState *m = module_by_index(i);
-		LineBuffer *lb = line_by_index(i);
 		if (m != NULL) {
 			memset(m, 0, sizeof(*m));
 			m->module_index = i;
-		}
-		if (lb != NULL) {
-			memset(lb, 0, sizeof(*lb));
+			m->baudrate = baudrate;
 		}
 	}
+	memset(line_scans, 0, sizeof(line_scans));
+	memset(baud_switches, 0, sizeof(baud_switches));
+	memset(autobaud_watches, 0, sizeof(autobaud_watches));
+	target_baud = baudrate;
+	active_modules = (uint8_t)GNSS_ACTIVE_MODULES;
+	active_request = active_modules;
+	boot_probe = GNSS_ACTIVE_AUTODETECT ? active_modules : 0u;
 
 	GnssUart_GpioInit();
 	GnssUart_HardwareUartsInit(baudrate);
 	GnssUart_SoftUartInit(baudrate);
 	GnssUart_StartHardwareRx();
+	GnssUart_SetActiveMask(active_modules);
+}
+
+void Gnss_SetActiveModules(uint8_t mask) {
+	active_request = mask;
+}
+
+uint8_t Gnss_GetActiveModules(void) {
+	return active_modules;
+}
+
+/* A module reports each epoch in both GGA and RMC; the UTC time tells a new epoch from a repeat. */
+static void note_fix_epoch(GnssModuleState *m, uint32_t time_ms_of_day) {
+	if (m->fix_epoch != 0 && m->fix_time_ms == time_ms_of_day) {
+		return;
+	}
+	m->fix_time_ms = time_ms_of_day;
+	m->fix_epoch++;
+	m->last_fix_tick = HAL_GetTick();
 }
 
 static void ingest_line(uint8_t module_index, const char *line) {
@@ -79,7 +180,7 @@ static void ingest_line(uint8_t module_index, const char *line) {
 		m->lat_e7 = gga.lat_e7;
 		m->lon_e7 = gga.lon_e7;
 		m->alt_cm = gga.alt_cm;
-		m->last_fix_tick = HAL_GetTick();
+		note_fix_epoch(m, gga.time_ms_of_day);
 		return;
 	}
 
@@ -91,51 +192,332 @@ static void ingest_line(uint8_t module_index, const char *line) {
 			m->lon_e7 = rmc.lon_e7;
 			m->speed_centi_ms = rmc.speed_centi_ms;
 			m->course_centi_deg = rmc.course_centi_deg;
-			m->last_fix_tick = HAL_GetTick();
+			note_fix_epoch(m, rmc.time_ms_of_day);
+			m->last_velocity_tick = m->last_fix_tick;
 		}
 		return;
 	}
 }
 
-static void ingest_bytes(uint8_t module_index, const uint8_t *data, size_t len) {
-	LineBuffer *lb = line_by_index(module_index);
-	if (lb == NULL) {
-		return;
-	}
+static void poll_module(uint8_t module_index) {
+	LineScan *ls = &line_scans[module_index - 1];
 
-	for (size_t i = 0; i < len; i++) {
-		char c = (char)data[i];
-		if (c == '\r') {
+	while (1) {
+		const uint8_t *data;
+		size_t n = GnssUart_Peek(module_index, ls->scanned, &data);
+		uint8_t generation = GnssUart_RxGeneration(module_index);
+		if (generation != ls->generation) {
+			/* The ring was emptied under the scan: start over from its new tail. */
+			ls->generation = generation;
+			ls->scanned = 0;
 			continue;
 		}
-		if (c == '\n') {
-			if (lb->used > 0) {
-				lb->line[lb->used] = '\0';
-				ingest_line(module_index, lb->line);
+		if (n == 0) {
+			return;
+		}
+
+		const uint8_t *nl = memchr(data, '\n', n);
+		if (nl == NULL) {
+			ls->scanned = (uint16_t)(ls->scanned + n);
+			if (ls->scanned > GNSS_LINE_MAX) {
+				/* Too long for a sentence (or noise at the wrong rate): drop it. */
+				GnssUart_Consume(module_index, ls->scanned);
+				ls->scanned = 0;
 			}
-			lb->used = 0;
 			continue;
 		}
-		if (lb->used + 1u >= sizeof(lb->line)) {
-			lb->used = 0;
+
+		size_t len = ls->scanned + (size_t)(nl - data);
+		ls->scanned = 0;
+		if (len > GNSS_LINE_MAX) {
+			GnssUart_Consume(module_index, len + 1u);
+			continue;
+		}
+		(void)GnssUart_ReadBytes(module_index, (uint8_t *)line_buffer, len + 1u);
+		if (len > 0 && line_buffer[len - 1u] == '\r') {
+			len--;
+		}
+		line_buffer[len] = '\0';
+		if (len > 0) {
+			ingest_line(module_index, line_buffer);
+		}
+	}
+}
+
+/* ATGM336H (CASIC) $PCAS01 baud rate codes. */
+static int pcas01_code(uint32_t baudrate) {
+	switch (baudrate) {
+	case 4800u:
+		return 0;
+	case 9600u:
+		return 1;
+	case 19200u:
+		return 2;
+	case 38400u:
+		return 3;
+	case 57600u:
+		return 4;
+	case 115200u:
+		return 5;
+	default:
+		return -1;
+	}
+}
+
+static bool send_pcas01(uint8_t module_index, uint32_t baudrate) {
+	int code = pcas01_code(baudrate);
+	if (code < 0) {
+		return false;
+	}
+	char body[] = "PCAS01,0";
+	body[sizeof(body) - 2u] = (char)('0' + code);
+
+	char sentence[16];
+	size_t len = Nmea_BuildSentence(body, sentence, sizeof(sentence));
+	return len > 0 && GnssUart_Write(module_index, (const uint8_t *)sentence, len) == len;
+}
+
+/* The requested rate, or the fastest standard rate below it that the module's channel can take. */
+static uint32_t module_target_baud(uint8_t module_index) {
+	uint32_t max_baud = GnssUart_MaxBaud(module_index);
+	uint32_t baud = target_baud;
+	while (baud > max_baud && baud > 4800u) {
+		baud = (baud == 115200u) ? 57600u : (baud == 57600u) ? 38400u : baud / 2u;
+	}
+	return baud;
+}
+
+static uint32_t valid_sentences(const GnssModuleState *m) {
+	return m->nmea_sentences - m->nmea_checksum_errors;
+}
+
+bool Gnss_RequestBaudrate(uint32_t baudrate) {
+	if (pcas01_code(baudrate) < 0) {
+		return false;
+	}
+	target_baud = baudrate;
+	for (uint8_t i = 1; i <= GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = module_by_index(i);
+		BaudSwitch *sw = &baud_switches[i - 1];
+		uint32_t to_baud = module_target_baud(i);
+		if (m == NULL || !module_active(i) || sw->state != BAUD_SWITCH_IDLE || GnssUart_GetBaud(i) == to_baud) {
 			continue;
 		}
-		lb->line[lb->used++] = c;
+		sw->from_baud = GnssUart_GetBaud(i);
+		sw->to_baud = to_baud;
+		sw->state = BAUD_SWITCH_PENDING;
+	}
+	return true;
+}
+
+bool Gnss_BaudSwitchPending(void) {
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (baud_switches[i].state != BAUD_SWITCH_IDLE) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void retune_channel(uint8_t module_index, uint32_t baudrate) {
+	GnssModuleState *m = module_by_index(module_index);
+	if (GnssUart_SetBaud(module_index, baudrate) && m != NULL) {
+		m->baudrate = baudrate;
+	}
+}
+
+/*
+ * Per-module baud switch: command the new rate at the old one, retune the channel, then require
+ * valid sentences at the new rate. A module that stays silent is commanded back to the old rate
+ * (at the new rate, in case it did switch) and its channel is returned to the old rate.
+ */
+static void service_baud_switch(uint8_t module_index, uint32_t now) {
+	BaudSwitch *sw = &baud_switches[module_index - 1];
+	GnssModuleState *m = module_by_index(module_index);
+	if (m == NULL) {
+		return;
+	}
+
+	switch (sw->state) {
+	case BAUD_SWITCH_IDLE:
+		break;
+	case BAUD_SWITCH_PENDING:
+		/* Auto-baud may have moved the channel since the request was queued. */
+		sw->from_baud = GnssUart_GetBaud(module_index);
+		if (sw->from_baud == sw->to_baud) {
+			sw->state = BAUD_SWITCH_IDLE;
+		} else if (send_pcas01(module_index, sw->to_baud)) {
+			sw->state = BAUD_SWITCH_COMMAND;
+			sw->since_tick = now;
+		}
+		break;
+	case BAUD_SWITCH_COMMAND:
+		if (GnssUart_TxBusy(module_index)) {
+			sw->since_tick = now;
+			break;
+		}
+		if ((now - sw->since_tick) >= BAUD_SWITCH_SETTLE_MS) {
+			retune_channel(module_index, sw->to_baud);
+			sw->valid_at_switch = valid_sentences(m);
+			sw->since_tick = now;
+			sw->state = BAUD_SWITCH_VERIFY;
+		}
+		break;
+	case BAUD_SWITCH_VERIFY:
+		if ((valid_sentences(m) - sw->valid_at_switch) >= BAUD_SWITCH_VERIFY_SENTENCES) {
+			sw->state = BAUD_SWITCH_IDLE;
+		} else if ((now - sw->since_tick) >= BAUD_SWITCH_VERIFY_TIMEOUT_MS) {
+			if (m->baud_switch_failures < 255u) {
+				m->baud_switch_failures++;
+			}
+			(void)send_pcas01(module_index, sw->from_baud);
+			sw->state = BAUD_SWITCH_ROLLBACK;
+		}
+		break;
+	case BAUD_SWITCH_ROLLBACK:
+		if (!GnssUart_TxBusy(module_index)) {
+			retune_channel(module_index, sw->from_baud);
+			sw->state = BAUD_SWITCH_IDLE;
+		}
+		break;
+	default:
+		sw->state = BAUD_SWITCH_IDLE;
+		break;
+	}
+}
+
+/*
+ * Per-module auto-baud: detect at startup and whenever a module goes silent. A module found at
+ * another rate is followed there first, then switched back to the requested rate.
+ */
+static void service_autobaud(uint8_t module_index, uint32_t now) {
+	AutoBaudWatch *w = &autobaud_watches[module_index - 1];
+	BaudSwitch *sw = &baud_switches[module_index - 1];
+	GnssModuleState *m = module_by_index(module_index);
+	if (m == NULL) {
+		return;
+	}
+
+	uint32_t valid = valid_sentences(m);
+	if (valid != w->valid_seen) {
+		w->valid_seen = valid;
+		w->last_valid_tick = now;
+		w->silence_ms = AUTOBAUD_SILENCE_MS;
+	}
+
+	if (w->detecting) {
+		uint32_t detected = 0;
+		if (!GnssUart_AutoBaudPoll(module_index, &detected)) {
+			return;
+		}
+		w->detecting = false;
+		w->last_valid_tick = now;
+		uint8_t bit = (uint8_t)(1u << (module_index - 1u));
+		if ((boot_probe & bit) != 0) {
+			bool silent = (detected == 0 && valid == 0);
+			if (silent && ++w->boot_failures < AUTOBAUD_BOOT_PROBES) {
+				w->detecting = GnssUart_AutoBaudStart(module_index);
+				if (w->detecting) {
+					return;
+				}
+			}
+			boot_probe &= (uint8_t)~bit;
+			if (silent && w->boot_failures >= AUTOBAUD_BOOT_PROBES) {
+				active_request &= (uint8_t)~bit;
+				return;
+			}
+		}
+		if (detected == 0) {
+			w->silence_ms = (w->silence_ms >= AUTOBAUD_SILENCE_MAX_MS / 2u) ? AUTOBAUD_SILENCE_MAX_MS
+			                                                              : w->silence_ms * 2u;
+			return;
+		}
+		if (detected != GnssUart_GetBaud(module_index)) {
+			retune_channel(module_index, detected);
+			if (m->autobaud_corrections < 0xFFFFu) {
+				m->autobaud_corrections++;
+			}
+		}
+		uint32_t to_baud = module_target_baud(module_index);
+		if (sw->state == BAUD_SWITCH_IDLE && detected != to_baud && pcas01_code(to_baud) >= 0) {
+			sw->to_baud = to_baud;
+			sw->state = BAUD_SWITCH_PENDING;
+		}
+		return;
+	}
+
+	/* A switch in progress verifies the channel itself. */
+	if (sw->state != BAUD_SWITCH_IDLE) {
+		w->last_valid_tick = now;
+		return;
+	}
+	if ((now - w->last_valid_tick) >= w->silence_ms) {
+		w->detecting = GnssUart_AutoBaudStart(module_index);
+		w->last_valid_tick = now;
+	}
+}
+
+/*
+ * Bring the receive path in line with the requested mask. Dropped modules lose their fix and any
+ * queued baud switch; added ones start with a rate detection, like every module at boot.
+ */
+static void apply_active_modules(uint8_t mask, uint32_t now) {
+	uint8_t added = (uint8_t)(mask & ~active_modules);
+	uint8_t dropped = (uint8_t)(active_modules & ~mask);
+	if (added == 0 && dropped == 0) {
+		return;
+	}
+	active_modules = mask;
+	boot_probe &= mask;
+	GnssUart_SetActiveMask(mask);
+
+	for (uint8_t module_index = 1; module_index <= GNSS_MODULE_COUNT; module_index++) {
+		uint8_t bit = (uint8_t)(1u << (module_index - 1u));
+		AutoBaudWatch *w = &autobaud_watches[module_index - 1];
+		if ((dropped & bit) != 0) {
+			modules[module_index - 1].has_fix = false;
+			baud_switches[module_index - 1].state = BAUD_SWITCH_IDLE;
+			line_scans[module_index - 1].scanned = 0;
+			w->detecting = false;
+		} else if ((added & bit) != 0) {
+			line_scans[module_index - 1].scanned = 0;
+			w->last_valid_tick = now;
+			w->silence_ms = AUTOBAUD_SILENCE_MS;
+			w->detecting = GnssUart_AutoBaudStart(module_index);
+		}
 	}
 }
 
 void Gnss_Task(void *argument) {
 	(void)argument;
 
-	uint8_t scratch[64];
+	uint32_t start = HAL_GetTick();
+	for (uint8_t module_index = 1; module_index <= GNSS_MODULE_COUNT; module_index++) {
+		if (!module_active(module_index)) {
+			continue;
+		}
+		AutoBaudWatch *w = &autobaud_watches[module_index - 1];
+		w->last_valid_tick = start;
+		w->silence_ms = AUTOBAUD_SILENCE_MS;
+		w->detecting = GnssUart_AutoBaudStart(module_index);
+		if (!w->detecting) {
+			boot_probe &= (uint8_t)~(1u << (module_index - 1u));
+		}
+	}
 
 	while (1) {
+		uint32_t now = HAL_GetTick();
+		apply_active_modules(active_request, now);
 		for (uint8_t module_index = 1; module_index <= GNSS_MODULE_COUNT; module_index++) {
-			size_t n = GnssUart_ReadBytes(module_index, scratch, sizeof(scratch));
-			if (n > 0) {
-				ingest_bytes(module_index, scratch, n);
+			if (!module_active(module_index)) {
+				continue;
+			}
+			poll_module(module_index);
+			service_autobaud(module_index, now);
+			if (!autobaud_watches[module_index - 1].detecting) {
+				service_baud_switch(module_index, now);
 			}
 		}
-		vTaskDelay(pdMS_TO_TICKS(5));
+		vTaskDelay(pdMS_TO_TICKS(GNSS_POLL_MS));
 	}
 }
@@ -0,0 +1,151 @@
+#include "gnss_enu.h"
+
+#include <stddef.h>
+
+/* 1e-7 degree of latitude is 1.1132 cm; scale factors are Q20 cm per 1e-7 degree. */
+#define CM_PER_E7_LAT_Q20 1167275 /* 1.1132 * 2^20 */
+#define Q30_ONE (1 << 30)
+#define LON_HALF_TURN_E7 1800000000LL
+
+typedef struct {
+	bool valid;
+	int32_t lat_e7;
+	int32_t lon_e7;
+	int32_t cm_per_e7_lon_q20;
+} EnuAnchor;
+
+static EnuAnchor anchor;
+
+/*
+ * cos() of a latitude in 1e-7 degrees (|lat| <= 90 degrees) as Q30, from the Taylor series up to
+ * x^12 evaluated in Horner form; the truncation error is below 1e-8 over the whole range.
+ */
+static int32_t cos_q30_e7(int32_t lat_e7) {
+	/* pi / 180e7 in Q62, so x = |lat_e7| * K >> 32 is the angle in radians as Q30. */
+	static const uint64_t kRadPerE7Q62 = 8048910509ull;
+	uint32_t deg = (lat_e7 < 0) ? (uint32_t)(-(int64_t)lat_e7) : (uint32_t)lat_e7;
+	if (deg > 900000000u) {
+		deg = 900000000u;
+	}
+	int64_t x = (int64_t)(((uint64_t)deg * kRadPerE7Q62) >> 32);
+	int64_t x2 = (x * x) >> 30;
+
+	static const int32_t kDivisors[] = {132, 90, 56, 30, 12, 2};
+	int64_t t = Q30_ONE;
+	for (size_t i = 0; i < sizeof(kDivisors) / sizeof(kDivisors[0]); i++) {
+		t = Q30_ONE - ((x2 * t) >> 30) / kDivisors[i];
+	}
+	return (int32_t)(t < 0 ? 0 : t);
+}
+
+static int32_t sat_i32(int64_t v) {
+	if (v > INT32_MAX) {
+		return INT32_MAX;
+	}
+	if (v < INT32_MIN) {
+		return INT32_MIN;
+	}
+	return (int32_t)v;
+}
+
+static int32_t div_round_i64(int64_t num, int64_t den) {
+	return sat_i32((num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den));
+}
+
+int32_t GnssEnu_WrapLon(int64_t lon_e7) {
+	while (lon_e7 >= LON_HALF_TURN_E7) {
+		lon_e7 -= 2 * LON_HALF_TURN_E7;
+	}
+	while (lon_e7 < -LON_HALF_TURN_E7) {
+		lon_e7 += 2 * LON_HALF_TURN_E7;
+	}
+	return (int32_t)lon_e7;
+}
+
+int32_t GnssEnu_LonDelta(int32_t lon_e7, int32_t ref_lon_e7) {
+	return GnssEnu_WrapLon((int64_t)lon_e7 - ref_lon_e7);
+}
+
+void GnssEnu_Init(void) {
+	anchor.valid = false;
+}
+
+bool GnssEnu_HasAnchor(void) {
+	return anchor.valid;
+}
+
+void GnssEnu_SetAnchor(int32_t lat_e7, int32_t lon_e7) {
+	anchor.lat_e7 = lat_e7;
+	anchor.lon_e7 = lon_e7;
+	anchor.cm_per_e7_lon_q20 = (int32_t)(((int64_t)CM_PER_E7_LAT_Q20 * cos_q30_e7(lat_e7)) >> 30);
+	anchor.valid = true;
+}
+
+bool GnssEnu_Follow(int32_t lat_e7, int32_t lon_e7) {
+	if (anchor.valid) {
+		int32_t east_cm;
+		int32_t north_cm;
+		GnssEnu_ToLocal(lat_e7, lon_e7, &east_cm, &north_cm);
+		if (east_cm <= GNSS_ENU_REANCHOR_CM && east_cm >= -GNSS_ENU_REANCHOR_CM &&
+		    north_cm <= GNSS_ENU_REANCHOR_CM && north_cm >= -GNSS_ENU_REANCHOR_CM) {
+			return false;
+		}
+	}
+	GnssEnu_SetAnchor(lat_e7, lon_e7);
+	return true;
+}
+
+/* Longitude differences are taken mod 360 degrees, so the antimeridian is crossed like any other. */
+void GnssEnu_ToLocal(int32_t lat_e7, int32_t lon_e7, int32_t *east_cm, int32_t *north_cm) {
+	int32_t dlon = GnssEnu_LonDelta(lon_e7, anchor.lon_e7);
+	int32_t dlat = lat_e7 - anchor.lat_e7;
+	*east_cm = sat_i32(((int64_t)dlon * anchor.cm_per_e7_lon_q20) >> 20);
+	*north_cm = sat_i32(((int64_t)dlat * CM_PER_E7_LAT_Q20) >> 20);
+}
+
+void GnssEnu_Offset(int32_t *lat_e7, int32_t *lon_e7, int32_t east_cm, int32_t north_cm) {
+	*lat_e7 += div_round_i64((int64_t)north_cm << 20, CM_PER_E7_LAT_Q20);
+	if (anchor.cm_per_e7_lon_q20 != 0) {
+		*lon_e7 = GnssEnu_WrapLon((int64_t)*lon_e7 + div_round_i64((int64_t)east_cm << 20, anchor.cm_per_e7_lon_q20));
+	}
+}
+
+void GnssEnu_VelocityFromCourse(uint16_t speed_centi_ms, uint16_t course_centi_deg, int32_t *east_cms,
+                                int32_t *north_cms) {
+	/* Reduce to a quadrant and an angle in [0, 90) degrees, then take sin as cos of the complement. */
+	uint32_t course = course_centi_deg % 36000u;
+	uint32_t quadrant = course / 9000u;
+	uint32_t rest = course % 9000u;
+	int64_t c = cos_q30_e7((int32_t)(rest * 100000u));
+	int64_t s = cos_q30_e7((int32_t)((9000u - rest) * 100000u));
+
+	int64_t sin_q30;
+	int64_t cos_q30;
+	switch (quadrant) {
+	case 0:
+		sin_q30 = s;
+		cos_q30 = c;
+		break;
+	case 1:
+		sin_q30 = c;
+		cos_q30 = -s;
+		break;
+	case 2:
+		sin_q30 = -s;
+		cos_q30 = -c;
+		break;
+	default:
+		sin_q30 = -c;
+		cos_q30 = s;
+		break;
+	}
+	*east_cms = (int32_t)div_round_i64(speed_centi_ms * sin_q30, Q30_ONE);
+	*north_cms = (int32_t)div_round_i64(speed_centi_ms * cos_q30, Q30_ONE);
+}
+
+void GnssEnu_FromLocal(int32_t east_cm, int32_t north_cm, int32_t *lat_e7, int32_t *lon_e7) {
+	*lat_e7 = anchor.lat_e7 + div_round_i64((int64_t)north_cm << 20, CM_PER_E7_LAT_Q20);
+	*lon_e7 = GnssEnu_WrapLon(
+	    (int64_t)anchor.lon_e7 +
+	    (anchor.cm_per_e7_lon_q20 == 0 ? 0 : div_round_i64((int64_t)east_cm << 20, anchor.cm_per_e7_lon_q20)));
+}
@@ -1,6 +1,5 @@
 #include "gnss_fusion.h"
 
-#include <math.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -8,33 +7,212 @@
 #include "task.h"
 
 #include "gnss.h"
+#include "gnss_enu.h"
+
+#ifndef GNSS_FUSION_PERIOD_MS
+#define GNSS_FUSION_PERIOD_MS 200u
+#endif
+
+/* Kalman process noise: white acceleration, in cm/s^2 (1 sigma). */
+#ifndef GNSS_FUSION_ACCEL_NOISE_CMS2
+#define GNSS_FUSION_ACCEL_NOISE_CMS2 50
+#endif
+
+/* Kalman measurement noise: position error per unit HDOP, in cm (1 sigma). */
+#ifndef GNSS_FUSION_UERE_CM
+#define GNSS_FUSION_UERE_CM 300
+#endif
+
+#ifndef GNSS_FUSION_DEFAULT_MODE
+#define GNSS_FUSION_DEFAULT_MODE GNSS_FUSION_MODE_GATE
+#endif
+
+/*
+ * Robust modes: reweighting passes are capped so the fusion cost stays bounded. robust_irls()
+ * computes residuals at most MAX_ITER + 1 times. Per module a pass costs one isqrt_u64 (~300
+ * cycles), one 64-bit divide in robust_factor_q16 (~200) and ~60 of multiplies, and each pass adds
+ * two 64-bit divides for the step. For 8 modules that is ~5.2k cycles a pass and ~31k (0.43 ms at
+ * 72 MHz) at the cap of 5, against ~2.7k for the single gate-mode residual pass. These are
+ * estimates; cycles_max in the diagnostics is the measured figure.
+ */
+#ifndef GNSS_FUSION_IRLS_MAX_ITER
+#define GNSS_FUSION_IRLS_MAX_ITER 5u
+#endif
+
+/* The Huber knee, as a fraction of a module's gate threshold. */
+#define HUBER_KNEE_DIV 4u
+
+#define Q16_ONE 65536u
+
+/*
+ * Vertical gate around the altitude median: 15 m + 10 m per unit HDOP. GGA carries no VDOP, so HDOP
+ * stands in for it; vertical error typically runs 1.5-2x the horizontal.
+ */
+#define ALT_GATE_BASE_CM 1500u
+#define ALT_GATE_MIN_CM 2000u
+#define ALT_GATE_MAX_CM 10000u
+
+/*
+ * Per-module bias: an exponential average of each accepted fix's offset from the fused position,
+ * over 2^GNSS_FUSION_BIAS_SHIFT fixes (about 2 minutes at 1 Hz). With GNSS_FUSION_BIAS_CORRECTION
+ * 0 it is still estimated but not subtracted.
+ */
+#ifndef GNSS_FUSION_BIAS_CORRECTION
+#define GNSS_FUSION_BIAS_CORRECTION 1
+#endif
+
+#ifndef GNSS_FUSION_BIAS_SHIFT
+#define GNSS_FUSION_BIAS_SHIFT 7
+#endif
+
+/* Largest bias corrected, per axis; anything beyond is a fault, not an antenna offset. */
+#define BIAS_MAX_CM 1000
+
+/* Residuals are clipped to this for the accuracy spread, so the weighted sums stay within int64. */
+#define SPREAD_MAX_CM 100000
+
+/*
+ * Plane differences are clipped to this (10,000 km) before squaring: GnssEnu_ToLocal() saturates at
+ * int32, so the difference of two saturated fixes reaches 2^32 and its square overflows int64.
+ */
+#define RESIDUAL_MAX_CM 1000000000
+
+/* Fixes (and RMC velocities) older than this are left out. */
+#define FIX_MAX_AGE_MS 2000u
+
+/* Velocity gate around the median vector: base plus 0.5 m/s per unit HDOP, in cm/s. */
+#define VEL_GATE_BASE_CMS 50u
+#define VEL_GATE_MAX_CMS 500u
+
+/* A track without measurements for this long restarts from the next fused fix. */
+#define TRACK_TIMEOUT_MS 5000u
+/* Initial velocity uncertainty of a new track, in cm/s (1 sigma). */
+#define TRACK_INIT_VEL_CMS 1000
+/* A fused fix this far from the track is a jump to restart from, not a measurement to smooth. */
+#define TRACK_JUMP_CM 100000
+
+/* Track positions are Q8 cm from the ENU anchor and must stay within int32. */
+#if GNSS_ENU_REANCHOR_CM > 2000000
+#error "GNSS_ENU_REANCHOR_CM must be at most 2000000 (20 km)"
+#endif
+
+/*
+ * Constant-velocity Kalman filter on the fused track: state (east, north, v_east, v_north) in
+ * centimetres from the ENU anchor, Q8 fixed point. Every measurement is a whole fix with the same
+ * noise on both axes, so the axes share one 2x2 covariance [p00 p01; p01 p11] (Q8 cm^2, cm^2/s,
+ * cm^2/s^2) and one gain per update.
+ */
+typedef struct {
+	bool valid;
+	uint32_t tick;
+	uint32_t last_measurement_tick;
+	int32_t pos_q8[2];
+	int32_t vel_q8[2];
+	int64_t p00;
+	int64_t p01;
+	int64_t p11;
+	/* fix_epoch of each module's fix already applied, so an epoch is used only once. */
+	uint32_t fix_epoch[GNSS_MODULE_COUNT];
+} FusionTrack;
+
+/* A module's fix as fused: its position propagated from the fix time to the fusion instant. */
+typedef struct {
+	const GnssModuleState *m;
+	int32_t lat_e7;
+	int32_t lon_e7;
+	int32_t alt_cm;
+	uint32_t robust_q16; /* Robust weight factor, Q16_ONE in gate mode. */
+} FusionInput;
+
+/* A module's bias in Q8 cm (east, north, up) and the fix epoch it was last updated from. */
+typedef struct {
+	int32_t q8[3];
+	uint32_t fix_epoch;
+} ModuleBias;
+
+/* Alignment applied during the current pass, published with the result. */
+typedef struct {
+	uint32_t max_age_ms;
+	uint32_t max_cm;
+	uint8_t track_velocity;
+} FusionAlignment;
 
 static GnssFusionResult latest;
 static uint16_t fault_score[GNSS_MODULE_COUNT];
+static GnssFusionDiagnostics diagnostics;
+static FusionTrack track;
+static FusionAlignment alignment;
+static ModuleBias module_bias[GNSS_MODULE_COUNT];
+static volatile GnssFusionMode fusion_mode = GNSS_FUSION_DEFAULT_MODE;
+static uint8_t irls_iterations;
 
-static void sort_i32(int32_t *values, size_t count) {
-	for (size_t i = 1; i < count; i++) {
-		int32_t v = values[i];
-		size_t j = i;
-		while (j > 0 && values[j - 1] > v) {
-			values[j] = values[j - 1];
-			j--;
-		}
-		values[j] = v;
+/*
+ * The fusion is integer-only: the F103 has no FPU. Residuals are centimetres in the shared ENU
+ * plane (gnss_enu.h), means are offsets from the median in 1e-7 degrees.
+ */
+
+/* Weights are 2^32 / hdop_centi^2, i.e. proportional to 1 / hdop^2. */
+#define HDOP_CENTI_MIN 50u
+#define HDOP_CENTI_MAX 5000u
+
+/*
+ * Median by an optimal sorting network over GNSS_MODULE_COUNT rounded up to 4, 6 or 8 inputs, the
+ * unused inputs padded with INT32_MAX so the real values sort to the front. Every compare-exchange
+ * is a min/max select (IT blocks on the M3), so the cost is the same for any data and any count.
+ */
+#if GNSS_MODULE_COUNT <= 4
+#define MEDIAN_NET_INPUTS 4
+static const uint8_t kMedianNet[][2] = {{0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}};
+#elif GNSS_MODULE_COUNT <= 6
+#define MEDIAN_NET_INPUTS 6
+static const uint8_t kMedianNet[][2] = {{0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3},
+                                        {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}};
+#elif GNSS_MODULE_COUNT <= 8
+#define MEDIAN_NET_INPUTS 8
+static const uint8_t kMedianNet[][2] = {{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+                                        {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+                                        {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+#else
+#error "median network only covers up to 8 modules"
+#endif
+
+static int32_t median_i32(const int32_t *values, size_t count) {
+	int32_t v[MEDIAN_NET_INPUTS];
+	for (size_t i = 0; i < MEDIAN_NET_INPUTS; i++) {
+		v[i] = (i < count) ? values[i] : INT32_MAX;
 	}
+	for (size_t i = 0; i < sizeof(kMedianNet) / sizeof(kMedianNet[0]); i++) {
+		int32_t a = v[kMedianNet[i][0]];
+		int32_t b = v[kMedianNet[i][1]];
+		v[kMedianNet[i][0]] = (a < b) ? a : b;
+		v[kMedianNet[i][1]] = (a < b) ? b : a;
+	}
+	return v[count / 2];
 }
 
-static int32_t median_i32(int32_t *values, size_t count) {
-	sort_i32(values, count);
-	return values[count / 2];
+static uint32_t isqrt_u64(uint64_t v) {
+	uint64_t root = 0;
+	uint64_t bit = 1ull << 62;
+	while (bit > v) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (v >= root + bit) {
+			v -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
 }
 
-void GnssFusion_Init(void) {
-	memset(&latest, 0, sizeof(latest));
-	memset(fault_score, 0, sizeof(fault_score));
+static int64_t div_round_i64(int64_t num, int64_t den) {
+	return (num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den);
 }
 
-static float clampf(float v, float lo, float hi) {
+static uint32_t clamp_u32(uint32_t v, uint32_t lo, uint32_t hi) {
 	if (v < lo) {
 		return lo;
 	}
@@ -44,12 +222,35 @@ static float clampf(float v, float lo, float hi) {
 	return v;
 }
 
+static int64_t clip_residual(int64_t d) {
+	return (d > RESIDUAL_MAX_CM) ? RESIDUAL_MAX_CM : ((d < -RESIDUAL_MAX_CM) ? -RESIDUAL_MAX_CM : d);
+}
+
+/* Length of a plane difference, each axis clipped first. */
+static uint32_t plane_distance_cm(int64_t de, int64_t dn) {
+	de = clip_residual(de);
+	dn = clip_residual(dn);
+	return isqrt_u64((uint64_t)(de * de) + (uint64_t)(dn * dn));
+}
+
+void GnssFusion_Init(void) {
+	memset(&latest, 0, sizeof(latest));
+	memset(fault_score, 0, sizeof(fault_score));
+	memset(&diagnostics, 0, sizeof(diagnostics));
+	memset(&track, 0, sizeof(track));
+	memset(module_bias, 0, sizeof(module_bias));
+	GnssEnu_Init();
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 static uint16_t clamp_u16(uint32_t v) {
 	return (uint16_t)(v > 65535u ? 65535u : v);
 }
 
-static void update_fault_score(uint8_t module_index, bool used, bool rejected, float residual_m,
-                               float threshold_m) {
+static void update_fault_score(uint8_t module_index, bool used, bool rejected, uint32_t residual_cm,
+                               uint32_t threshold_cm) {
 	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
 		return;
 	}
@@ -66,9 +267,9 @@ static void update_fault_score(uint8_t module_index, bool used, bool rejected, f
 		return;
 	}
 
-	if (residual_m < (threshold_m * 0.5f)) {
+	if (residual_cm < (threshold_cm / 2u)) {
 		*score = (uint16_t)(*score > 2u ? (*score - 2u) : 0u);
-	} else if (residual_m > threshold_m) {
+	} else if (residual_cm > threshold_cm) {
 		uint32_t next = (uint32_t)(*score) + 2u;
 		*score = (uint16_t)(next > 500u ? 500u : next);
 	} else {
@@ -76,25 +277,617 @@ static void update_fault_score(uint8_t module_index, bool used, bool rejected, f
 	}
 }
 
+static void publish(const GnssFusionResult *r, uint32_t start_cycles) {
+	uint32_t cycles = DWT->CYCCNT - start_cycles;
+	taskENTER_CRITICAL();
+	latest = *r;
+	diagnostics.runs++;
+	diagnostics.cycles_last = cycles;
+	diagnostics.align_max_age_ms = alignment.max_age_ms;
+	diagnostics.align_max_cm = alignment.max_cm;
+	diagnostics.align_track_velocity = alignment.track_velocity;
+	diagnostics.irls_iterations = irls_iterations;
+	if (cycles > diagnostics.cycles_max) {
+		diagnostics.cycles_max = cycles;
+	}
+	taskEXIT_CRITICAL();
+}
+
+/* Local east/north of a fix, Q8 cm, saturated so a far outlier still fits in int32. */
+static void track_to_local(int32_t lat_e7, int32_t lon_e7, int32_t *out_q8) {
+	int32_t local_cm[2];
+	GnssEnu_ToLocal(lat_e7, lon_e7, &local_cm[0], &local_cm[1]);
+	for (size_t axis = 0; axis < 2; axis++) {
+		int32_t cm = local_cm[axis];
+		cm = (cm > INT32_MAX / 256) ? INT32_MAX / 256 : ((cm < INT32_MIN / 256) ? INT32_MIN / 256 : cm);
+		out_q8[axis] = cm * 256;
+	}
+}
+
+static void track_to_geodetic(const int32_t *pos_q8, int32_t *lat_e7, int32_t *lon_e7) {
+	GnssEnu_FromLocal((pos_q8[0] + 128) >> 8, (pos_q8[1] + 128) >> 8, lat_e7, lon_e7);
+}
+
+static void track_start(FusionTrack *t, int32_t lat_e7, int32_t lon_e7, uint32_t hdop_centi, uint32_t now) {
+	int64_t sigma_cm = ((int64_t)GNSS_FUSION_UERE_CM * hdop_centi) / 100;
+	track_to_local(lat_e7, lon_e7, t->pos_q8);
+	memset(t->vel_q8, 0, sizeof(t->vel_q8));
+	t->p00 = (sigma_cm * sigma_cm) << 8;
+	t->p01 = 0;
+	t->p11 = ((int64_t)TRACK_INIT_VEL_CMS * TRACK_INIT_VEL_CMS) << 8;
+	t->tick = now;
+	t->last_measurement_tick = now;
+	t->valid = true;
+}
+
+/* Advance state and covariance by dt_ms under white-acceleration process noise. */
+static void track_predict(FusionTrack *t, uint32_t now) {
+	int64_t dt = (int32_t)(now - t->tick);
+	if (dt <= 0) {
+		return;
+	}
+	t->tick = now;
+	for (size_t axis = 0; axis < 2; axis++) {
+		t->pos_q8[axis] += (int32_t)div_round_i64((int64_t)t->vel_q8[axis] * dt, 1000);
+	}
+
+	const int64_t q = ((int64_t)GNSS_FUSION_ACCEL_NOISE_CMS2 * GNSS_FUSION_ACCEL_NOISE_CMS2) << 8;
+	t->p00 += (2 * t->p01 * dt) / 1000 + (t->p11 * dt * dt) / 1000000 + (q * dt * dt * dt) / 3000000000ll;
+	t->p01 += (t->p11 * dt) / 1000 + (q * dt * dt) / 2000000;
+	t->p11 += (q * dt) / 1000;
+}
+
+/* Fold in one fix with variance r_q8 (Q8 cm^2) on each axis. */
+static void track_update(FusionTrack *t, const int32_t *z_q8, int64_t r_q8) {
+	int64_t s_q8 = t->p00 + r_q8;
+	if (s_q8 <= 0) {
+		return;
+	}
+	int64_t k0_q16 = (t->p00 << 16) / s_q8;
+	int64_t k1_q16 = (t->p01 << 16) / s_q8; /* 1/s */
+	for (size_t axis = 0; axis < 2; axis++) {
+		int64_t y = (int64_t)z_q8[axis] - t->pos_q8[axis];
+		t->pos_q8[axis] += (int32_t)((k0_q16 * y) >> 16);
+		t->vel_q8[axis] += (int32_t)((k1_q16 * y) >> 16);
+	}
+	int64_t p01 = t->p01;
+	t->p00 -= (k0_q16 * t->p00) >> 16;
+	t->p01 -= (k0_q16 * p01) >> 16;
+	t->p11 -= (k1_q16 * p01) >> 16;
+}
+
+/*
+ * Move the ENU anchor to `lat_e7`/`lon_e7` if that is out of range, carrying the track over: its
+ * position is re-expressed from the new anchor, the sub-centimetre part kept.
+ */
+static void track_follow_anchor(FusionTrack *t, int32_t lat_e7, int32_t lon_e7) {
+	int32_t track_lat_e7 = 0;
+	int32_t track_lon_e7 = 0;
+	int32_t east_cm = 0;
+	int32_t north_cm = 0;
+	if (t->valid && GnssEnu_HasAnchor()) {
+		east_cm = (t->pos_q8[0] + 128) >> 8;
+		north_cm = (t->pos_q8[1] + 128) >> 8;
+		GnssEnu_FromLocal(east_cm, north_cm, &track_lat_e7, &track_lon_e7);
+	}
+	if (!GnssEnu_Follow(lat_e7, lon_e7) || !t->valid) {
+		return;
+	}
+	int32_t rebased_east_cm;
+	int32_t rebased_north_cm;
+	GnssEnu_ToLocal(track_lat_e7, track_lon_e7, &rebased_east_cm, &rebased_north_cm);
+	if (rebased_east_cm > TRACK_JUMP_CM || rebased_east_cm < -TRACK_JUMP_CM || rebased_north_cm > TRACK_JUMP_CM ||
+	    rebased_north_cm < -TRACK_JUMP_CM) {
+		t->valid = false;
+		return;
+	}
+	t->pos_q8[0] = rebased_east_cm * 256 + (t->pos_q8[0] - east_cm * 256);
+	t->pos_q8[1] = rebased_north_cm * 256 + (t->pos_q8[1] - north_cm * 256);
+}
+
+/*
+ * Run the track to `now` and apply the fixes of `used` that are new since the last pass. The
+ * published position is the filtered one at `now`, so passes between receiver epochs output a
+ * prediction rather than the last epoch's average.
+ */
+static void track_step(GnssFusionResult *r, const FusionInput *used, size_t used_count, uint32_t now) {
+	FusionTrack *t = &track;
+	if (t->valid && (now - t->last_measurement_tick) > TRACK_TIMEOUT_MS) {
+		t->valid = false;
+	}
+	if (t->valid) {
+		int32_t fix_q8[2];
+		track_to_local(r->lat_e7, r->lon_e7, fix_q8);
+		int64_t de = ((int64_t)fix_q8[0] - t->pos_q8[0]) / 256;
+		int64_t dn = ((int64_t)fix_q8[1] - t->pos_q8[1]) / 256;
+		if (de > TRACK_JUMP_CM || de < -TRACK_JUMP_CM || dn > TRACK_JUMP_CM || dn < -TRACK_JUMP_CM) {
+			t->valid = false;
+		}
+	}
+	if (!t->valid) {
+		track_start(t, r->lat_e7, r->lon_e7, r->avg_hdop_centi, now);
+	} else {
+		track_predict(t, now);
+	}
+
+	for (size_t i = 0; i < used_count; i++) {
+		const GnssModuleState *m = used[i].m;
+		size_t slot = m->module_index - 1u;
+		if (t->fix_epoch[slot] == m->fix_epoch) {
+			continue;
+		}
+		t->fix_epoch[slot] = m->fix_epoch;
+
+		/* A down-weighted fix counts as a noisier measurement. */
+		int64_t sigma_cm = ((int64_t)GNSS_FUSION_UERE_CM * clamp_u32(m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX)) / 100;
+		int64_t r_q8 = (sigma_cm * sigma_cm) << 8;
+		r_q8 = (r_q8 * Q16_ONE) / (used[i].robust_q16 == 0 ? 1u : used[i].robust_q16);
+		int32_t z_q8[2];
+		track_to_local(used[i].lat_e7, used[i].lon_e7, z_q8);
+		track_update(t, z_q8, r_q8);
+		t->last_measurement_tick = now;
+	}
+
+	track_to_geodetic(t->pos_q8, &r->lat_e7, &r->lon_e7);
+}
+
+static uint32_t gate_threshold_cm(uint32_t hdop_centi) {
+	return clamp_u32(2000u + 15u * hdop_centi, 2500u, 15000u);
+}
+
+static uint32_t hdop_weight(uint32_t hdop_centi) {
+	return (uint32_t)(0xFFFFFFFFu / (hdop_centi * hdop_centi));
+}
+
+/* Huber or Tukey weight factor (Q16) for a residual against the module's gate threshold. */
+static uint32_t robust_factor_q16(GnssFusionMode mode, uint32_t residual_cm, uint32_t threshold_cm) {
+	if (mode == GNSS_FUSION_MODE_HUBER) {
+		uint32_t knee_cm = threshold_cm / HUBER_KNEE_DIV;
+		if (residual_cm <= knee_cm) {
+			return Q16_ONE;
+		}
+		return (uint32_t)(((uint64_t)knee_cm << 16) / residual_cm);
+	}
+	if (residual_cm >= threshold_cm) {
+		return 0;
+	}
+	uint32_t x_q16 = (uint32_t)(((uint64_t)residual_cm << 16) / threshold_cm);
+	uint32_t t_q16 = Q16_ONE - (uint32_t)(((uint64_t)x_q16 * x_q16) >> 16);
+	return (uint32_t)(((uint64_t)t_q16 * t_q16) >> 16);
+}
+
+/*
+ * Iteratively reweighted least squares in the ENU plane, starting from the median. Each pass
+ * recomputes every residual against the current estimate and moves the estimate to the robustly
+ * weighted mean; it stops on a move below 1 cm or after GNSS_FUSION_IRLS_MAX_ITER passes. Leaves
+ * each candidate's factor and final residual; returns the passes taken.
+ */
+static uint8_t robust_irls(GnssFusionMode mode, FusionInput *in, const int32_t *east_cm, const int32_t *north_cm,
+                           size_t count, int32_t est_east_cm, int32_t est_north_cm, uint32_t *residual_cm) {
+	uint8_t iterations = 0;
+	bool converged = false;
+	while (1) {
+		int64_t sum_w = 0;
+		int64_t east_w = 0;
+		int64_t north_w = 0;
+		for (size_t i = 0; i < count; i++) {
+			int64_t dx = clip_residual((int64_t)east_cm[i] - est_east_cm);
+			int64_t dy = clip_residual((int64_t)north_cm[i] - est_north_cm);
+			residual_cm[i] = plane_distance_cm(dx, dy);
+			uint32_t hdop_centi = clamp_u32(in[i].m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+			in[i].robust_q16 = robust_factor_q16(mode, residual_cm[i], gate_threshold_cm(hdop_centi));
+			int64_t w = ((int64_t)hdop_weight(hdop_centi) * in[i].robust_q16) >> 16;
+			sum_w += w;
+			east_w += w * dx;
+			north_w += w * dy;
+		}
+		if (converged || iterations >= GNSS_FUSION_IRLS_MAX_ITER || sum_w == 0) {
+			return iterations;
+		}
+		int64_t step_east = div_round_i64(east_w, sum_w);
+		int64_t step_north = div_round_i64(north_w, sum_w);
+		est_east_cm += (int32_t)step_east;
+		est_north_cm += (int32_t)step_north;
+		iterations++;
+		/* After a sub-centimetre move, one more pass only refreshes factors and residuals. */
+		converged = step_east <= 1 && step_east >= -1 && step_north <= 1 && step_north >= -1;
+	}
+}
+
+static bool velocity_fresh(const GnssModuleState *m, uint32_t now) {
+	return m->last_velocity_tick != 0 && (now - m->last_velocity_tick) <= FIX_MAX_AGE_MS;
+}
+
+/*
+ * Fuse the RMC ground velocity of the position-accepted modules: speed and course become east/north
+ * vectors, vectors too far from the per-component median are dropped, the rest are averaged with
+ * the position weights.
+ */
+static void fuse_velocity(GnssFusionResult *r, const FusionInput *used, const uint32_t *weights, size_t used_count,
+                          uint32_t now) {
+	int32_t ve[GNSS_MODULE_COUNT];
+	int32_t vn[GNSS_MODULE_COUNT];
+	uint32_t w[GNSS_MODULE_COUNT];
+	uint16_t hdop[GNSS_MODULE_COUNT];
+	size_t count = 0;
+	for (size_t i = 0; i < used_count; i++) {
+		const GnssModuleState *m = used[i].m;
+		if (!velocity_fresh(m, now)) {
+			continue;
+		}
+		GnssEnu_VelocityFromCourse(m->speed_centi_ms, m->course_centi_deg, &ve[count], &vn[count]);
+		w[count] = weights[i];
+		hdop[count] = m->hdop_centi;
+		count++;
+	}
+	if (count == 0) {
+		return;
+	}
+
+	int32_t med_e = median_i32(ve, count);
+	int32_t med_n = median_i32(vn, count);
+
+	int64_t sum_w = 0;
+	int64_t e_w = 0;
+	int64_t n_w = 0;
+	size_t accepted = 0;
+	for (size_t i = 0; i < count; i++) {
+		int64_t de = (int64_t)ve[i] - med_e;
+		int64_t dn = (int64_t)vn[i] - med_n;
+		uint32_t gate = clamp_u32(VEL_GATE_BASE_CMS + hdop[i] / 2u, VEL_GATE_BASE_CMS, VEL_GATE_MAX_CMS);
+		if (plane_distance_cm(de, dn) > gate) {
+			continue;
+		}
+		sum_w += w[i];
+		e_w += (int64_t)w[i] * ve[i];
+		n_w += (int64_t)w[i] * vn[i];
+		accepted++;
+	}
+	if (accepted == 0) {
+		return;
+	}
+	r->vel_e_cms = (int32_t)div_round_i64(e_w, sum_w);
+	r->vel_n_cms = (int32_t)div_round_i64(n_w, sum_w);
+	r->velocity_modules = (uint8_t)accepted;
+}
+
+static int64_t clip_spread(int64_t d) {
+	return (d > SPREAD_MAX_CM) ? SPREAD_MAX_CM : ((d < -SPREAD_MAX_CM) ? -SPREAD_MAX_CM : d);
+}
+
+/*
+ * Weighted second moment over the effective fix count less one (n_eff = sum_w^2 / sum_w2), i.e. the
+ * unbiased spread of a mean. Below two fixes' worth of weight the spread itself is used.
+ */
+static int64_t spread_of_mean(int64_t moment_w, int64_t sum_w, uint64_t sum_w2) {
+	int64_t n_eff_q8 = (int64_t)((((uint64_t)sum_w * (uint64_t)sum_w) << 8) / sum_w2);
+	int64_t dof_q8 = (n_eff_q8 < 512) ? 256 : (n_eff_q8 - 256);
+	return (moment_w / sum_w) * 256 / dof_q8;
+}
+
+/* Variance of a weighted mean: its measured spread, but never below the HDOP model's. */
+static uint32_t mean_variance(int64_t moment_w, int64_t sum_w, uint64_t sum_w2, uint64_t model) {
+	uint64_t var = (uint64_t)spread_of_mean(moment_w, sum_w, sum_w2);
+	if (var < model) {
+		var = model;
+	}
+	return (var > UINT32_MAX) ? UINT32_MAX : (uint32_t)var;
+}
+
+/* 95% radius over the major-axis sigma, Q8, for minor/major sigma = 0, 1/8, ..., 1. */
+static const uint16_t kCep95PerSigmaQ8[9] = {502, 503, 506, 512, 521, 536, 560, 590, 627};
+
+/* Radius holding 95% of a 2-D normal with the given east/north covariance (cm^2). */
+static uint32_t cep95_cm(uint32_t var_east, uint32_t var_north, int32_t cov_en) {
+	int64_t half_sum = ((int64_t)var_east + var_north) / 2;
+	int64_t half_diff = ((int64_t)var_east - var_north) / 2;
+	int64_t root = isqrt_u64((uint64_t)(half_diff * half_diff) + (uint64_t)((int64_t)cov_en * cov_en));
+	uint32_t sigma_major = isqrt_u64((uint64_t)(half_sum + root));
+	uint32_t sigma_minor = isqrt_u64((uint64_t)((half_sum > root) ? (half_sum - root) : 0));
+	if (sigma_major == 0) {
+		return 0;
+	}
+	uint32_t ratio_q8 = (uint32_t)(((uint64_t)sigma_minor << 8) / sigma_major);
+	uint32_t idx = ratio_q8 >> 5;
+	uint32_t k_q8 = kCep95PerSigmaQ8[8];
+	if (idx < 8) {
+		k_q8 = kCep95PerSigmaQ8[idx] + (((kCep95PerSigmaQ8[idx + 1] - kCep95PerSigmaQ8[idx]) * (ratio_q8 & 31u)) >> 5);
+	}
+	return (uint32_t)(((uint64_t)sigma_major * k_q8 + 128u) >> 8);
+}
+
+/*
+ * Error every module shares (atmosphere, a common antenna environment) does not average out
+ * across modules or epochs, so no estimate may go below one fix's: UERE x the best used HDOP,
+ * scaled by num/den (cm^2). The horizontal floor splits it over the two axes.
+ */
+static uint32_t common_mode_cm2(const FusionInput *used, size_t used_count, uint32_t num, uint32_t den) {
+	uint32_t hdop_min = HDOP_CENTI_MAX;
+	for (size_t i = 0; i < used_count; i++) {
+		uint32_t hdop_centi = clamp_u32(used[i].m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+		if (hdop_centi < hdop_min) {
+			hdop_min = hdop_centi;
+		}
+	}
+	uint64_t sigma_cm = (uint64_t)GNSS_FUSION_UERE_CM * hdop_min;
+	return (uint32_t)((sigma_cm * sigma_cm * num) / (10000u * (uint64_t)den));
+}
+
+/*
+ * Horizontal spread of the epoch: the weighted east/north spread of the used fixes about their
+ * fused mean, over their effective count less one. Left in the result for publish_accuracy().
+ */
+static void fuse_spread(GnssFusionResult *r, const FusionInput *used, const uint32_t *weights, size_t used_count) {
+	int32_t fused_east_cm;
+	int32_t fused_north_cm;
+	GnssEnu_ToLocal(r->lat_e7, r->lon_e7, &fused_east_cm, &fused_north_cm);
+
+	int64_t sum_w = 0;
+	uint64_t sum_w2 = 0;
+	int64_t ee_w = 0;
+	int64_t nn_w = 0;
+	int64_t en_w = 0;
+	for (size_t i = 0; i < used_count; i++) {
+		int32_t east_cm;
+		int32_t north_cm;
+		GnssEnu_ToLocal(used[i].lat_e7, used[i].lon_e7, &east_cm, &north_cm);
+		int64_t de = clip_spread((int64_t)east_cm - fused_east_cm);
+		int64_t dn = clip_spread((int64_t)north_cm - fused_north_cm);
+		int64_t w = weights[i];
+		sum_w += w;
+		sum_w2 += (uint64_t)w * (uint64_t)w;
+		ee_w += w * de * de;
+		nn_w += w * dn * dn;
+		en_w += w * de * dn;
+	}
+
+	r->var_east_cm2 = mean_variance(ee_w, sum_w, sum_w2, 0);
+	r->var_north_cm2 = mean_variance(nn_w, sum_w, sum_w2, 0);
+	int64_t cov = spread_of_mean(en_w, sum_w, sum_w2);
+	r->cov_en_cm2 = (int32_t)((cov > INT32_MAX) ? INT32_MAX : ((cov < -INT32_MAX) ? -INT32_MAX : cov));
+}
+
+/*
+ * Horizontal accuracy of the published (tracked) fix: the track's position variance plus the
+ * common-mode floor on each axis, or the epoch's spread where the fixes disagree by more. The
+ * east/north correlation is the epoch's.
+ */
+static void publish_accuracy(GnssFusionResult *r, const FusionInput *used, size_t used_count) {
+	uint64_t floor_cm2 = common_mode_cm2(used, used_count, 1u, 2u);
+	uint64_t track_cm2 = (uint64_t)(track.p00 > 0 ? track.p00 : 0) / 256u + floor_cm2;
+	if (track_cm2 > UINT32_MAX) {
+		track_cm2 = UINT32_MAX;
+	}
+	if (r->var_east_cm2 < track_cm2) {
+		r->var_east_cm2 = (uint32_t)track_cm2;
+	}
+	if (r->var_north_cm2 < track_cm2) {
+		r->var_north_cm2 = (uint32_t)track_cm2;
+	}
+	r->std_horizontal_cm = clamp_u16(isqrt_u64((uint64_t)r->var_east_cm2 + r->var_north_cm2));
+	r->cep95_cm = clamp_u16(cep95_cm(r->var_east_cm2, r->var_north_cm2, r->cov_en_cm2));
+}
+
+static uint32_t alt_threshold_cm(uint32_t hdop_centi) {
+	return clamp_u32(ALT_GATE_BASE_CM + 10u * hdop_centi, ALT_GATE_MIN_CM, ALT_GATE_MAX_CM);
+}
+
+/*
+ * Fuse the altitude of the position-accepted modules on its own: fixes too far from the altitude
+ * median are dropped (or, in the robust modes, down-weighted by their vertical residual) so a
+ * module with a good horizontal fix but a bad height stays out of alt_cm.
+ */
+static void fuse_altitude(GnssFusionResult *r, const FusionInput *used, size_t used_count, GnssFusionMode mode) {
+	int32_t alt[GNSS_MODULE_COUNT];
+	for (size_t i = 0; i < used_count; i++) {
+		alt[i] = used[i].alt_cm;
+	}
+	int32_t med_alt = median_i32(alt, used_count);
+
+	int64_t sum_w = 0;
+	int64_t alt_w = 0;
+	size_t rejected = 0;
+	size_t accepted = 0;
+	uint32_t acc_w[GNSS_MODULE_COUNT];
+	int64_t acc_d[GNSS_MODULE_COUNT];
+	for (size_t i = 0; i < used_count; i++) {
+		int64_t d = (int64_t)alt[i] - med_alt;
+		uint32_t residual_cm = (uint32_t)(d < 0 ? -d : d);
+		uint32_t hdop_centi = clamp_u32(used[i].m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+		uint32_t threshold_cm = alt_threshold_cm(hdop_centi);
+
+		uint32_t factor_q16 = Q16_ONE;
+		if (mode == GNSS_FUSION_MODE_HUBER || mode == GNSS_FUSION_MODE_TUKEY) {
+			factor_q16 = robust_factor_q16(mode, residual_cm, threshold_cm);
+		} else if (residual_cm > threshold_cm) {
+			factor_q16 = 0;
+		}
+		if (factor_q16 == 0) {
+			rejected++;
+			continue;
+		}
+
+		uint32_t w = (uint32_t)(((uint64_t)hdop_weight(hdop_centi) * factor_q16) >> 16);
+		w = (w == 0) ? 1u : w;
+		sum_w += w;
+		alt_w += (int64_t)w * d;
+		acc_w[accepted] = w;
+		acc_d[accepted] = d;
+		accepted++;
+	}
+
+	/* The median itself always passes, so sum_w > 0. */
+	int64_t mean_d = div_round_i64(alt_w, sum_w);
+	r->alt_cm = med_alt + (int32_t)mean_d;
+	r->alt_rejected_modules = (uint8_t)rejected;
+
+	/* Vertical error taken as 1.5x the horizontal (UERE x HDOP), GGA having no VDOP. */
+	uint64_t sum_w2 = 0;
+	int64_t spread_w = 0;
+	for (size_t i = 0; i < accepted; i++) {
+		int64_t d = clip_spread(acc_d[i] - mean_d);
+		sum_w2 += (uint64_t)acc_w[i] * acc_w[i];
+		spread_w += (int64_t)acc_w[i] * d * d;
+	}
+	uint64_t model = ((uint64_t)9u * GNSS_FUSION_UERE_CM * GNSS_FUSION_UERE_CM << 32) / (40000u * (uint64_t)sum_w);
+	uint64_t floor_cm2 = common_mode_cm2(used, used_count, 9u, 4u);
+	uint32_t var_up = mean_variance(spread_w, sum_w, sum_w2, (model > floor_cm2) ? model : floor_cm2);
+	r->std_up_cm = clamp_u16(isqrt_u64(var_up));
+}
+
+/*
+ * Propagate a fix over its age to `now`, with the module's own RMC velocity or else the track's, so
+ * modules reporting at different instants are compared and averaged at the same one.
+ */
+static void align_input(FusionInput *in, uint32_t now) {
+	const GnssModuleState *m = in->m;
+	in->lat_e7 = m->lat_e7;
+	in->lon_e7 = m->lon_e7;
+	in->alt_cm = m->alt_cm;
+
+	int32_t ve_cms;
+	int32_t vn_cms;
+	if (velocity_fresh(m, now)) {
+		GnssEnu_VelocityFromCourse(m->speed_centi_ms, m->course_centi_deg, &ve_cms, &vn_cms);
+	} else if (track.valid) {
+		ve_cms = track.vel_q8[0] / 256;
+		vn_cms = track.vel_q8[1] / 256;
+		alignment.track_velocity++;
+	} else {
+		return;
+	}
+
+	uint32_t age_ms = now - m->last_fix_tick;
+	int32_t de_cm = (int32_t)div_round_i64((int64_t)ve_cms * age_ms, 1000);
+	int32_t dn_cm = (int32_t)div_round_i64((int64_t)vn_cms * age_ms, 1000);
+	GnssEnu_Offset(&in->lat_e7, &in->lon_e7, de_cm, dn_cm);
+
+	uint32_t shift_cm = plane_distance_cm(de_cm, dn_cm);
+	if (age_ms > alignment.max_age_ms) {
+		alignment.max_age_ms = age_ms;
+	}
+	if (shift_cm > alignment.max_cm) {
+		alignment.max_cm = shift_cm;
+	}
+}
+
+static int32_t bias_cm(const ModuleBias *b, size_t axis) {
+	return (int32_t)div_round_i64(b->q8[axis], 256);
+}
+
+/* Subtract the module's bias from its aligned fix. */
+static void remove_bias(FusionInput *in) {
+#if GNSS_FUSION_BIAS_CORRECTION
+	const ModuleBias *b = &module_bias[in->m->module_index - 1u];
+	GnssEnu_Offset(&in->lat_e7, &in->lon_e7, -bias_cm(b, 0), -bias_cm(b, 1));
+	in->alt_cm -= bias_cm(b, 2);
+#else
+	(void)in;
+#endif
+}
+
+/* One step of the bias average towards a raw offset (residual plus the bias already removed). */
+static void bias_step(ModuleBias *b, size_t axis, int32_t residual_cm) {
+	int64_t offset_q8 = (int64_t)residual_cm * 256;
+#if GNSS_FUSION_BIAS_CORRECTION
+	offset_q8 += (int64_t)bias_cm(b, axis) * 256;
+#endif
+	int64_t next = b->q8[axis] + div_round_i64(offset_q8 - b->q8[axis], 1 << GNSS_FUSION_BIAS_SHIFT);
+	if (next > BIAS_MAX_CM * 256) {
+		next = BIAS_MAX_CM * 256;
+	} else if (next < -BIAS_MAX_CM * 256) {
+		next = -BIAS_MAX_CM * 256;
+	}
+	b->q8[axis] = (int32_t)next;
+}
+
+/*
+ * Learn each used module's bias from its offset to this pass's fused position, once per fix
+ * epoch. Only residuals within the gates count, so a Huber-down-weighted outlier does not become
+ * a "bias".
+ */
+static void update_bias(const GnssFusionResult *r, const FusionInput *used, size_t used_count) {
+	int32_t fused_east_cm;
+	int32_t fused_north_cm;
+	GnssEnu_ToLocal(r->lat_e7, r->lon_e7, &fused_east_cm, &fused_north_cm);
+
+	bool stepped = false;
+	for (size_t i = 0; i < used_count; i++) {
+		const GnssModuleState *m = used[i].m;
+		ModuleBias *b = &module_bias[m->module_index - 1u];
+		if (b->fix_epoch == m->fix_epoch) {
+			continue;
+		}
+		b->fix_epoch = m->fix_epoch;
+		stepped = true;
+
+		uint32_t hdop_centi = clamp_u32(m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+		int32_t east_cm;
+		int32_t north_cm;
+		GnssEnu_ToLocal(used[i].lat_e7, used[i].lon_e7, &east_cm, &north_cm);
+		int64_t de = (int64_t)east_cm - fused_east_cm;
+		int64_t dn = (int64_t)north_cm - fused_north_cm;
+		if (plane_distance_cm(de, dn) <= gate_threshold_cm(hdop_centi)) {
+			bias_step(b, 0, (int32_t)de);
+			bias_step(b, 1, (int32_t)dn);
+		}
+		int64_t du = (int64_t)used[i].alt_cm - r->alt_cm;
+		if ((uint64_t)(du < 0 ? -du : du) <= alt_threshold_cm(hdop_centi)) {
+			bias_step(b, 2, (int32_t)du);
+		}
+	}
+
+	if (!stepped) {
+		return;
+	}
+
+	/* Only offsets between modules are observable: keep the learned biases zero-mean. */
+	for (size_t axis = 0; axis < 3; axis++) {
+		int64_t sum = 0;
+		int32_t learned = 0;
+		for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+			if (module_bias[i].fix_epoch != 0) {
+				sum += module_bias[i].q8[axis];
+				learned++;
+			}
+		}
+		if (learned == 0) {
+			continue;
+		}
+		int32_t mean = (int32_t)div_round_i64(sum, learned);
+		for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+			if (module_bias[i].fix_epoch != 0) {
+				module_bias[i].q8[axis] -= mean;
+			}
+		}
+	}
+}
+
 static void compute_fusion(void) {
+	uint32_t start_cycles = DWT->CYCCNT;
 	const GnssModuleState *modules = Gnss_GetModules();
+	uint8_t active = Gnss_GetActiveModules();
 
 	uint32_t now = HAL_GetTick();
+	memset(&alignment, 0, sizeof(alignment));
 
-	const GnssModuleState *candidates[GNSS_MODULE_COUNT] = {0};
+	FusionInput candidates[GNSS_MODULE_COUNT];
 	size_t candidate_count = 0;
 	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
 		const GnssModuleState *m = &modules[i];
+		if ((active & (1u << i)) == 0) {
+			continue;
+		}
 		if (!m->has_fix || m->fix_quality == 0 || m->hdop_centi == 0) {
 			continue;
 		}
-		if ((now - m->last_fix_tick) > 2000u) {
+		if ((now - m->last_fix_tick) > FIX_MAX_AGE_MS) {
 			continue;
 		}
 		if (fault_score[i] >= 100u) {
 			continue;
 		}
-		candidates[candidate_count++] = m;
+		candidates[candidate_count++].m = m;
 	}
 
 	GnssFusionResult r = {0};
@@ -102,94 +895,122 @@ static void compute_fusion(void) {
 
 	if (candidate_count == 0) {
 		r.status = GNSS_FUSION_NO_FIX;
-		taskENTER_CRITICAL();
-		latest = r;
-		taskEXIT_CRITICAL();
+		publish(&r, start_cycles);
 		return;
 	}
 
+	if (!GnssEnu_HasAnchor()) {
+		GnssEnu_SetAnchor(candidates[0].m->lat_e7, candidates[0].m->lon_e7);
+	}
+	/* Longitudes are taken relative to the first candidate, so a cluster on the antimeridian stays together. */
 	int32_t lat_buf[GNSS_MODULE_COUNT];
 	int32_t lon_buf[GNSS_MODULE_COUNT];
 	for (size_t i = 0; i < candidate_count; i++) {
-		lat_buf[i] = candidates[i]->lat_e7;
-		lon_buf[i] = candidates[i]->lon_e7;
+		align_input(&candidates[i], now);
+		remove_bias(&candidates[i]);
+		lat_buf[i] = candidates[i].lat_e7;
+		lon_buf[i] = GnssEnu_LonDelta(candidates[i].lon_e7, candidates[0].lon_e7);
 	}
 
 	int32_t med_lat_e7 = median_i32(lat_buf, candidate_count);
-	int32_t med_lon_e7 = median_i32(lon_buf, candidate_count);
-	float med_lat_deg = (float)med_lat_e7 * 1e-7f;
-	float lat_rad = med_lat_deg * (float)(3.14159265358979323846 / 180.0);
-	float meters_per_deg_lon = 111320.0f * cosf(lat_rad);
-
-	const GnssModuleState *used[GNSS_MODULE_COUNT] = {0};
-	float used_weights[GNSS_MODULE_COUNT] = {0};
-	float used_residual_m[GNSS_MODULE_COUNT] = {0};
+	int32_t med_lon_e7 =
+	    GnssEnu_WrapLon((int64_t)candidates[0].lon_e7 + median_i32(lon_buf, candidate_count));
+	track_follow_anchor(&track, med_lat_e7, med_lon_e7);
+	int32_t med_east_cm;
+	int32_t med_north_cm;
+	GnssEnu_ToLocal(med_lat_e7, med_lon_e7, &med_east_cm, &med_north_cm);
+
+	int32_t cand_east_cm[GNSS_MODULE_COUNT];
+	int32_t cand_north_cm[GNSS_MODULE_COUNT];
+	uint32_t cand_residual_cm[GNSS_MODULE_COUNT];
+	for (size_t i = 0; i < candidate_count; i++) {
+		GnssEnu_ToLocal(candidates[i].lat_e7, candidates[i].lon_e7, &cand_east_cm[i], &cand_north_cm[i]);
+	}
+
+	GnssFusionMode mode = fusion_mode;
+	irls_iterations = 0;
+	if (mode == GNSS_FUSION_MODE_HUBER || mode == GNSS_FUSION_MODE_TUKEY) {
+		irls_iterations = robust_irls(mode, candidates, cand_east_cm, cand_north_cm, candidate_count, med_east_cm,
+		                              med_north_cm, cand_residual_cm);
+	} else {
+		for (size_t i = 0; i < candidate_count; i++) {
+			int64_t dx_cm = (int64_t)cand_east_cm[i] - med_east_cm;
+			int64_t dy_cm = (int64_t)cand_north_cm[i] - med_north_cm;
+			cand_residual_cm[i] = plane_distance_cm(dx_cm, dy_cm);
+			uint32_t hdop_centi = clamp_u32(candidates[i].m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+			candidates[i].robust_q16 = (cand_residual_cm[i] > gate_threshold_cm(hdop_centi)) ? 0u : Q16_ONE;
+		}
+	}
+
+	FusionInput used[GNSS_MODULE_COUNT];
+	uint32_t used_weights[GNSS_MODULE_COUNT] = {0};
+	uint32_t used_residual_cm[GNSS_MODULE_COUNT] = {0};
 	size_t used_count = 0;
 	size_t rejected_count = 0;
 
 	for (size_t i = 0; i < candidate_count; i++) {
-		const GnssModuleState *m = candidates[i];
-		float dy_m = ((float)(m->lat_e7 - med_lat_e7) * 1e-7f) * 111320.0f;
-		float dx_m = ((float)(m->lon_e7 - med_lon_e7) * 1e-7f) * meters_per_deg_lon;
-		float residual_m = sqrtf(dx_m * dx_m + dy_m * dy_m);
+		const GnssModuleState *m = candidates[i].m;
+		uint32_t hdop_centi = clamp_u32(m->hdop_centi, HDOP_CENTI_MIN, HDOP_CENTI_MAX);
+		uint32_t threshold_cm = gate_threshold_cm(hdop_centi);
+		uint32_t residual_cm = cand_residual_cm[i];
 
-		float hdop = clampf((float)m->hdop_centi * 0.01f, 0.5f, 50.0f);
-		float threshold_m = clampf(20.0f + 15.0f * hdop, 25.0f, 150.0f);
-
-		bool reject = residual_m > threshold_m;
-		update_fault_score(m->module_index, !reject, reject, residual_m, threshold_m);
+		bool reject = candidates[i].robust_q16 == 0;
+		update_fault_score(m->module_index, !reject, reject, residual_cm, threshold_cm);
 
 		if (reject) {
 			rejected_count++;
 			continue;
 		}
 
-		float w = 1.0f / (hdop * hdop);
-		used[used_count] = m;
-		used_weights[used_count] = w;
-		used_residual_m[used_count] = residual_m;
+		used[used_count] = candidates[i];
+		/* A far Huber outlier keeps a small but non-zero weight. */
+		uint32_t weight = (uint32_t)(((uint64_t)hdop_weight(hdop_centi) * candidates[i].robust_q16) >> 16);
+		used_weights[used_count] = weight == 0 ? 1u : weight;
+		used_residual_cm[used_count] = residual_cm;
 		used_count++;
 	}
 
 	if (used_count == 0) {
 		for (size_t i = 0; i < candidate_count; i++) {
-			update_fault_score(candidates[i]->module_index, false, true, 0.0f, 0.0f);
+			update_fault_score(candidates[i].m->module_index, false, true, 0u, 0u);
 		}
 		r.status = GNSS_FUSION_NO_FIX;
-		taskENTER_CRITICAL();
-		latest = r;
-		taskEXIT_CRITICAL();
+		publish(&r, start_cycles);
 		return;
 	}
 
-	float sum_w = 0.0f;
-	float lat_w = 0.0f;
-	float lon_w = 0.0f;
-	float alt_w = 0.0f;
+	/* Weighted means of the offsets from the median, exact to the last 1e-7 degree / cm. */
+	int64_t sum_w = 0;
+	int64_t lat_w = 0;
+	int64_t lon_w = 0;
 	uint32_t hdop_sum = 0;
 
-	float max_residual_m = 0.0f;
+	uint32_t max_residual_cm = 0;
 	for (size_t i = 0; i < used_count; i++) {
-		const GnssModuleState *m = used[i];
-		float w = used_weights[i];
+		const GnssModuleState *m = used[i].m;
+		int64_t w = used_weights[i];
 		sum_w += w;
-		lat_w += w * (float)m->lat_e7;
-		lon_w += w * (float)m->lon_e7;
-		alt_w += w * (float)m->alt_cm;
+		lat_w += w * (used[i].lat_e7 - med_lat_e7);
+		lon_w += w * GnssEnu_LonDelta(used[i].lon_e7, med_lon_e7);
 		hdop_sum += m->hdop_centi;
-		if (used_residual_m[i] > max_residual_m) {
-			max_residual_m = used_residual_m[i];
+		if (used_residual_cm[i] > max_residual_cm) {
+			max_residual_cm = used_residual_cm[i];
 		}
 	}
 
 	r.has_fix = true;
-	r.lat_e7 = (int32_t)(lat_w / sum_w);
-	r.lon_e7 = (int32_t)(lon_w / sum_w);
-	r.alt_cm = (int32_t)(alt_w / sum_w);
+	r.lat_e7 = med_lat_e7 + (int32_t)div_round_i64(lat_w, sum_w);
+	r.lon_e7 = GnssEnu_WrapLon((int64_t)med_lon_e7 + div_round_i64(lon_w, sum_w));
 	r.used_modules = (uint8_t)used_count;
 	r.rejected_modules = (uint8_t)rejected_count;
-	r.max_residual_cm = clamp_u16((uint32_t)(max_residual_m * 100.0f));
+	r.max_residual_cm = clamp_u16(max_residual_cm);
 	r.avg_hdop_centi = (uint16_t)(hdop_sum / used_count);
+	fuse_altitude(&r, used, used_count, mode);
+	fuse_spread(&r, used, used_weights, used_count);
+	update_bias(&r, used, used_count);
+	fuse_velocity(&r, used, used_weights, used_count, now);
+	track_step(&r, used, used_count, now);
+	publish_accuracy(&r, used, used_count);
 
 	if (used_count >= 4 && rejected_count <= 1 && r.max_residual_cm < 3000u && r.avg_hdop_centi < 250u) {
 		r.status = GNSS_FUSION_OK;
@@ -199,9 +1020,7 @@ static void compute_fusion(void) {
 		r.status = GNSS_FUSION_DEGRADED;
 	}
 
-	taskENTER_CRITICAL();
-	latest = r;
-	taskEXIT_CRITICAL();
+	publish(&r, start_cycles);
 }
 
 void GnssFusion_Task(void *argument) {
@@ -209,7 +1028,7 @@ void GnssFusion_Task(void *argument) {
 
 	while (1) {
 		compute_fusion();
-		vTaskDelay(pdMS_TO_TICKS(200));
+		vTaskDelay(pdMS_TO_TICKS(GNSS_FUSION_PERIOD_MS));
 	}
 }
 
@@ -242,3 +1061,36 @@ bool GnssFusion_GetModuleFaultScore(uint8_t module_index, uint16_t *out_score) {
 	taskEXIT_CRITICAL();
 	return true;
 }
+
+bool GnssFusion_GetDiagnostics(GnssFusionDiagnostics *out) {
+	if (out == NULL) {
+		return false;
+	}
+	taskENTER_CRITICAL();
+	*out = diagnostics;
+	taskEXIT_CRITICAL();
+	return true;
+}
+
+bool GnssFusion_GetModuleBias(uint8_t module_index, GnssFusionBias *out) {
+	if (out == NULL || module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return false;
+	}
+	taskENTER_CRITICAL();
+	const ModuleBias *b = &module_bias[module_index - 1];
+	out->east_cm = bias_cm(b, 0);
+	out->north_cm = bias_cm(b, 1);
+	out->up_cm = bias_cm(b, 2);
+	taskEXIT_CRITICAL();
+	return true;
+}
+
+void GnssFusion_SetMode(GnssFusionMode mode) {
+	if (mode == GNSS_FUSION_MODE_GATE || mode == GNSS_FUSION_MODE_HUBER || mode == GNSS_FUSION_MODE_TUKEY) {
+		fusion_mode = mode;
+	}
+}
+
+GnssFusionMode GnssFusion_GetMode(void) {
+	return fusion_mode;
+}
@@ -12,36 +12,306 @@ static UART_HandleTypeDef huart3;
 #define GNSS_UART_RING_SIZE 256u
 #endif
 
+/*
+ * Receive ring size per module slot (#1..#8), each a power of two; 0 leaves the module without a
+ * receiver. Size a channel from its data rate and poll latency: `ring_high_water` in
+ * GnssUart_GetStats() shows how much of its ring a channel actually uses.
+ */
+#ifndef GNSS_UART_RING_SIZES
+#define GNSS_UART_RING_SIZES \
+	{GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE, \
+	 GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE, GNSS_UART_RING_SIZE}
+#endif
+
+/* Smallest ring that still holds a complete sentence, which Gnss_Task assembles in place. */
+#define RX_RING_MIN 128u
+
+#ifndef GNSS_UART_RX_ARENA_SIZE
+#define GNSS_UART_RX_ARENA_SIZE (GNSS_MODULE_COUNT * GNSS_UART_RING_SIZE)
+#endif
+
+/*
+ * Single-producer/single-consumer ring. The producer (ISR or DMA) owns `head`, the consumer task
+ * owns `tail`; indices stay in [0, size) so a DMA write position can be published as `head`
+ * directly. Ordering is explicit: the producer fills the buffer before a barrier and the store to
+ * `head` (release), the consumer loads `head` then barriers before touching the data (acquire),
+ * and barriers again before handing the space back through `tail`.
+ *
+ * A producer that restarts (DMA recovery) moves only `head` back to 0 and bumps `reset_request`;
+ * the consumer zeroes its own `tail` when it next sees the request, so neither side ever writes
+ * the other's index while the ring is live.
+ */
 typedef struct {
-	volatile uint16_t head;
-	volatile uint16_t tail;
-	uint8_t buffer[GNSS_UART_RING_SIZE];
+	uint16_t head;
+	uint16_t tail;
+	uint16_t mask; /* Size - 1; the size is a power of two. */
+	volatile uint8_t reset_request; /* Producer-owned: bumped with every restart of `head`. */
+	uint8_t reset_seen;             /* Consumer-owned: last request matched by zeroing `tail`. */
+	uint8_t generation;             /* Consumer-owned: bumped whenever unread bytes are discarded. */
+	uint8_t *buffer;
 } RingBuffer;
 
-static RingBuffer rb_usart1;
-static RingBuffer rb_usart2;
-static RingBuffer rb_usart3;
+/* Every module's receive ring, hardware (DMA target) or software, is carved out of one arena. */
+static const uint16_t kRingSizes[GNSS_MODULE_COUNT] = GNSS_UART_RING_SIZES;
+static uint8_t rx_arena[GNSS_UART_RX_ARENA_SIZE] __attribute__((aligned(4)));
+static RingBuffer rx_rings[GNSS_MODULE_COUNT];
+
+/* Receive-path counters per module slot; written from interrupts, copied out under PRIMASK. */
+static GnssUartStats rx_stats[GNSS_MODULE_COUNT];
+
+/*
+ * Samples per bit at the fastest software channel's rate. Each bit is decided by a majority vote
+ * of three samples around its centre and every falling edge inside a frame re-centres the channel,
+ * so 3 or 4 still holds +/-3% baud error while cutting the sample and decode rate accordingly.
+ * The default of 4 keeps a 57600 baud array at 230.4k samples/s per port (1800 decode interrupts
+ * per second with the default block); 8 would double both for no gain in tolerance.
+ */
+#ifndef GNSS_SOFT_UART_OVERSAMPLE
+#define GNSS_SOFT_UART_OVERSAMPLE 4u
+#endif
+
+#if GNSS_SOFT_UART_OVERSAMPLE < 3u || GNSS_SOFT_UART_OVERSAMPLE > 10u
+#error "GNSS_SOFT_UART_OVERSAMPLE must be between 3 and 10"
+#endif
+
+/*
+ * Highest standard rate a sampled software channel accepts. The decode interrupt runs once per
+ * sample: at 115200 x 4 that leaves 156 CPU cycles per sample for the whole decoder, which has not
+ * been shown to fit with the fusion task running, so sampled channels stop at 57600 (312 cycles).
+ * Check `isr_load_permille_max` in GnssUart_GetStats() on hardware before raising it.
+ */
+#ifndef GNSS_SOFT_UART_MAX_BAUD
+#define GNSS_SOFT_UART_MAX_BAUD 57600u
+#endif
+
+#define SOFT_UART_OVERSAMPLE GNSS_SOFT_UART_OVERSAMPLE
+/* Phase counter planes: enough for a 4800 baud channel sampled at 115200 * 10. */
+#define SOFT_UART_PHASE_BITS_MAX 8u
+
+/* Frame slots sampled per channel: start bit, 8 data bits, stop bit. */
+#define SOFT_UART_FRAME_START 0u
+#define SOFT_UART_FRAME_STOP 9u
 
-typedef enum {
-	SOFT_RX_IDLE = 0,
-	SOFT_RX_START = 1,
-	SOFT_RX_DATA = 2,
-	SOFT_RX_STOP = 3,
-} SoftRxState;
+#ifndef GNSS_SOFT_UART_TX_RING_SIZE
+#define GNSS_SOFT_UART_TX_RING_SIZE 48u
+#endif
+
+/*
+ * Transmit side of a software channel. TIM1 counts TIM2 sample ticks and interrupts once per bit
+ * of the fastest software channel while any frame is in flight; slower channels divide that down.
+ */
+typedef struct {
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	uint8_t buffer[GNSS_SOFT_UART_TX_RING_SIZE];
+	uint16_t frame; /* Remaining frame bits, LSB first. */
+	uint8_t bits_left;
+	uint8_t ticks_left;
+	uint8_t ticks_per_bit; /* TIM1 updates per bit at this channel's baud rate. */
+} SoftUartTx;
 
 typedef struct {
-	SoftRxState state;
-	uint8_t sub_tick;
 	uint8_t bit_index;
 	uint8_t byte;
-	RingBuffer rb;
+	SoftUartTx tx;
 } SoftUartChannel;
 
 static SoftUartChannel soft_channels[GNSS_MODULE_COUNT];
+static volatile uint8_t soft_tx_active; /* Bit per module slot with a frame in flight. */
+
+/* Per-module line rate. Software channels share a sample clock of soft_rate_baud * oversample. */
+static uint32_t module_baud[GNSS_MODULE_COUNT];
+static uint32_t soft_rate_baud;
+
+/* Bit per module slot whose receive path runs; see GnssUart_SetActiveMask(). */
+static uint8_t rx_active_mask = 0xFFu;
+
+static bool slot_active(size_t slot) {
+	return (rx_active_mask & (1u << slot)) != 0;
+}
+
+/*
+ * Sample clock and per-channel reloads for the sampled decoder, in the plane form of the fields
+ * of the same name below. soft_uart_timing_apply() builds them in task context.
+ */
+typedef struct {
+	uint32_t rate_baud;
+	uint16_t psc;
+	uint16_t arr;
+	uint32_t tick_cycles; /* CPU cycles per sample tick. */
+	uint32_t phase_bits;
+	uint32_t bit_reload[SOFT_UART_PHASE_BITS_MAX];
+	uint32_t start_reload[SOFT_UART_PHASE_BITS_MAX];
+	uint32_t autobaud_mask;
+	uint8_t tx_ticks_per_bit[GNSS_MODULE_COUNT];
+} SoftUartTiming;
+
+/*
+ * Bit-sliced decoder state. All software channels are advanced together on a 32-bit sample word
+ * laid out as (GPIOB->IDR << 16) | GPIOA->IDR, so every mask below uses the RX pin bit positions
+ * directly. `phase` is a vertical down-counter (one plane per counter bit) holding the ticks left
+ * until each busy channel's next mid-bit sample point.
+ */
+typedef struct {
+	uint32_t rx_mask;
+	uint32_t busy;
+	uint32_t phase[SOFT_UART_PHASE_BITS_MAX];
+	uint32_t activity; /* Channels that started a frame in the current block. */
+	uint32_t history[2]; /* The two previous sample words, newest first. */
+	uint32_t at_stop;    /* Busy channels whose next sample point is the stop bit. */
+
+	/*
+	 * Per-channel counter reload values in plane form, so channels at different baud rates share
+	 * one sample clock: `bit_reload` is ticks-per-bit - 1, `start_reload` half a bit, which puts
+	 * the vote point one tick past the centre of the bit that starts at the current tick.
+	 */
+	uint32_t phase_bits;
+	uint32_t bit_reload[SOFT_UART_PHASE_BITS_MAX];
+	uint32_t start_reload[SOFT_UART_PHASE_BITS_MAX];
+	uint8_t slot_for_bit[32];
+
+	/* EXTI gating: sampling only runs while some channel may be mid-frame. */
+	uint32_t exti_mask;
+	volatile bool sampling;
+
+	/*
+	 * Auto-baud edge timing, in sample ticks, for the channels in `autobaud_mask`. Channels in
+	 * `autobaud_request` join it once the sample clock runs at the auto-baud rate.
+	 */
+	uint32_t tick;
+	uint32_t autobaud_mask;
+	uint32_t autobaud_request;
+	uint32_t autobaud_last;
+
+	/* Sample index in the ring where TIM2 switched to soft_timing_next, not yet decoded past. */
+	bool retime_armed;
+	uint16_t retime_at;
+} SoftUartDecoder;
+
+static SoftUartDecoder soft_decoder;
+static SoftUartTiming soft_timing_next;
+static volatile bool soft_timing_pending; /* soft_timing_next waits for a half-buffer boundary. */
+
+/*
+ * Decode interrupt cost, shared by every sampled channel's stats: the longest run in CPU cycles,
+ * and the highest share of the CPU it took over the samples it decoded, per mille.
+ */
+static uint32_t soft_tick_cycles;
+static uint32_t soft_decode_cycles_max;
+static uint32_t soft_decode_load_max;
+
+/*
+ * Auto-baud: the shortest pulses on a channel's RX line are one bit long. The median of the
+ * AUTOBAUD_SHORT_PULSES shortest is taken as the bit time, so a pulse or two cut short (an edge
+ * stamped late behind a masked section) do not set the rate. Hardware USART channels time both
+ * edges of the RX pin from EXTI against DWT->CYCCNT with the receiver disabled, sampled software
+ * channels time edges in sample ticks and capture channels reuse their edge timestamps.
+ */
+#ifndef GNSS_AUTOBAUD_MIN_PULSES
+#define GNSS_AUTOBAUD_MIN_PULSES 32u
+#endif
+
+#ifndef GNSS_AUTOBAUD_TIMEOUT_MS
+#define GNSS_AUTOBAUD_TIMEOUT_MS 2500u
+#endif
+
+/*
+ * Priority of the EXTI vectors shared by the soft UART wake-up and hardware auto-baud. Auto-baud
+ * stamps each edge on interrupt entry, so the vectors sit above the receive interrupts; both
+ * handlers are a few register accesses and make no RTOS calls.
+ */
+#define GNSS_UART_EXTI_IRQ_PRIORITY 4u
+
+#define AUTOBAUD_MAX_BAUD 115200u
+/* Sample clock rate while a sampled channel is auto-bauded; it never has to detect a faster one. */
+#define SOFT_UART_AUTOBAUD_BAUD \
+	(GNSS_SOFT_UART_MAX_BAUD < AUTOBAUD_MAX_BAUD ? GNSS_SOFT_UART_MAX_BAUD : AUTOBAUD_MAX_BAUD)
+#define AUTOBAUD_SHORT_PULSES 7u
+
+typedef struct {
+	volatile bool active;
+	uint32_t start_tick;
+	uint32_t glitch_width; /* Pulses shorter than half a bit at AUTOBAUD_MAX_BAUD are noise. */
+	volatile uint32_t short_widths[AUTOBAUD_SHORT_PULSES]; /* Shortest pulses seen, ascending. */
+	volatile uint16_t pulses;
+	uint32_t last_edge;
+	bool have_edge;
+	uint8_t level; /* Hardware channels: RX level after the last timed edge. */
+} AutoBaud;
+
+static AutoBaud autobaud[GNSS_MODULE_COUNT];
+
+/* EXTI lines timing a hardware USART channel's auto-baud, and the slot behind each line. */
+static volatile uint32_t autobaud_exti_mask;
+static uint8_t autobaud_exti_slot[16];
+
+static const uint32_t kAutoBaudRates[] = {4800u, 9600u, 19200u, 38400u, 57600u, 115200u};
+
+/*
+ * The RX pins are not sampled by the CPU: TIM2 update triggers DMA1 channel 2 (GPIOB->IDR) and
+ * TIM2 CC3, half a tick later, triggers DMA1 channel 1 (GPIOA->IDR). Both land in ping-pong
+ * buffers and each half is decoded in bulk from the channel 1 half/full-transfer interrupt.
+ */
+#ifndef GNSS_SOFT_UART_SAMPLE_BLOCK
+#define GNSS_SOFT_UART_SAMPLE_BLOCK 128u
+#endif
+
+static uint16_t soft_samples_a[2u * GNSS_SOFT_UART_SAMPLE_BLOCK];
+static uint16_t soft_samples_b[2u * GNSS_SOFT_UART_SAMPLE_BLOCK];
+
+/*
+ * Software channels on timer-capable pins skip sampling altogether: the timer captures every
+ * transition (toggling the capture polarity after each edge, as F1 timers cannot capture both
+ * edges) and the ISR only queues the timestamp. Bytes are rebuilt from edge times in task context.
+ * The F103 has no DMA request for these capture channels, so each edge costs one short interrupt.
+ */
+#ifndef GNSS_CAPTURE_CHANNEL_MAX
+#define GNSS_CAPTURE_CHANNEL_MAX 2u
+#endif
+
+#ifndef GNSS_CAPTURE_EDGE_RING
+#define GNSS_CAPTURE_EDGE_RING 256u
+#endif
+
+#define CAPTURE_TICK_HZ 8000000u
+#define CAPTURE_TIME_MASK 0x7FFFFFFFu
+/* Longest gap an edge entry can encode (4 ms at 8 MHz); longer gaps saturate. */
+#define CAPTURE_DELTA_MAX 0x7FFFu
+
+typedef struct {
+	TIM_TypeDef *timer;
+	uint8_t channel;
+	uint8_t slot;
+	GPIO_TypeDef *rx_port;
+	uint16_t rx_pin;
+
+	volatile uint16_t overflow;
+	/*
+	 * Edge queue, (delta << 1) | level-after-edge, delta in CAPTURE_TICK_HZ ticks since the previous
+	 * queued edge, saturated at CAPTURE_DELTA_MAX. `edge_last` is the full time of the newest entry
+	 * (ticks mod 2^31), so the task can re-anchor after a saturated gap.
+	 */
+	volatile uint16_t edge_head;
+	volatile uint16_t edge_tail;
+	volatile uint32_t edge_last;
+	uint16_t edges[GNSS_CAPTURE_EDGE_RING];
+
+	/* Task-side frame reconstruction; `edge_time` is the time of the last edge taken off the queue. */
+	uint32_t edge_time;
+	uint32_t bit_ticks_q8;
+	uint32_t frame_start;
+	bool in_frame;
+	uint8_t level;
+	uint8_t bit_index;
+	uint8_t byte;
+} CaptureRxChannel;
 
-static uint8_t rx_byte_usart1;
-static uint8_t rx_byte_usart2;
-static uint8_t rx_byte_usart3;
+static CaptureRxChannel capture_channels[GNSS_CAPTURE_CHANNEL_MAX];
+static size_t capture_channel_count;
+
+static void capture_rx_poll(CaptureRxChannel *c);
+static CaptureRxChannel *capture_for_slot(size_t slot);
+static void autobaud_exti_stop(size_t slot);
 
 const GnssUartPins kGnssUartPins[GNSS_MODULE_COUNT] = {
 	{.module_index = 1,
@@ -67,7 +337,9 @@ const GnssUartPins kGnssUartPins[GNSS_MODULE_COUNT] = {
 	 .tx_pin = GPIO_PIN_8,
 	 .rx_port = GPIOB,
 	 .rx_pin = GPIO_PIN_9,
-	 .uart_instance = NULL},
+	 .uart_instance = NULL,
+	 .capture_timer = TIM4,
+	 .capture_channel = 4},
 	{.module_index = 5,
 	 .tx_port = GPIOB,
 	 .tx_pin = GPIO_PIN_12,
@@ -91,58 +363,88 @@ const GnssUartPins kGnssUartPins[GNSS_MODULE_COUNT] = {
 	 .tx_pin = GPIO_PIN_6,
 	 .rx_port = GPIOA,
 	 .rx_pin = GPIO_PIN_7,
-	 .uart_instance = NULL},
+	 .uart_instance = NULL,
+	 .capture_timer = TIM3,
+	 .capture_channel = 2},
 };
 
-static UART_HandleTypeDef *hardware_handle_for_instance(USART_TypeDef *instance) {
-	if (instance == USART1) {
-		return &huart1;
-	}
-	if (instance == USART2) {
-		return &huart2;
-	}
-	if (instance == USART3) {
-		return &huart3;
-	}
-	return NULL;
-}
+/*
+ * Hardware USART RX runs on DMA1 in circular mode straight into the ring buffer storage; the DMA
+ * write position becomes the ring head. One constant descriptor per USART carries everything the
+ * receive interrupts need. Request mapping on STM32F103:
+ * - USART3_RX: DMA1 channel 3
+ * - USART1_RX: DMA1 channel 5
+ * - USART2_RX: DMA1 channel 6
+ */
+typedef struct {
+	USART_TypeDef *instance;
+	UART_HandleTypeDef *huart;
+	RingBuffer *rb;
+	DMA_Channel_TypeDef *dma;
+	uint8_t dma_flag_shift; /* Bit offset of the channel's flag group in DMA1->ISR / DMA1->IFCR. */
+	uint8_t slot;           /* Module slot in kGnssUartPins. */
+} UsartRxChannel;
 
-static RingBuffer *ring_for_instance(USART_TypeDef *instance) {
-	if (instance == USART1) {
-		return &rb_usart1;
-	}
-	if (instance == USART2) {
-		return &rb_usart2;
-	}
-	if (instance == USART3) {
-		return &rb_usart3;
-	}
-	return NULL;
-}
+static const UsartRxChannel kUsartRx[GNSS_UART_RX_COUNT] = {
+	[GNSS_UART_RX_USART3] = {USART3, &huart3, &rx_rings[0], DMA1_Channel3, 4u * (3u - 1u), 0},
+	[GNSS_UART_RX_USART2] = {USART2, &huart2, &rx_rings[1], DMA1_Channel6, 4u * (6u - 1u), 1},
+	[GNSS_UART_RX_USART1] = {USART1, &huart1, &rx_rings[2], DMA1_Channel5, 4u * (5u - 1u), 2},
+};
 
-static uint8_t *rx_byte_for_instance(USART_TypeDef *instance) {
-	if (instance == USART1) {
-		return &rx_byte_usart1;
-	}
-	if (instance == USART2) {
-		return &rx_byte_usart2;
-	}
-	if (instance == USART3) {
-		return &rx_byte_usart3;
+#define USART_RX_COUNT ((size_t)GNSS_UART_RX_COUNT)
+
+static const UsartRxChannel *usart_rx_for_module(uint8_t module_index) {
+	for (size_t i = 0; i < USART_RX_COUNT; i++) {
+		if (kUsartRx[i].slot + 1u == module_index) {
+			return &kUsartRx[i];
+		}
 	}
 	return NULL;
 }
 
 UART_HandleTypeDef *GnssUart_GetHardwareHandle(uint8_t module_index) {
+	const UsartRxChannel *u = usart_rx_for_module(module_index);
+	return (u != NULL) ? u->huart : NULL;
+}
+
+/*
+ * Carve the receive rings out of rx_arena in slot order. A size that is not a power of two is
+ * rounded down, and a ring that no longer fits is halved until it does, down to RX_RING_MIN.
+ */
+static void rx_arena_init(void) {
+	size_t used = 0;
 	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
-		if (kGnssUartPins[i].module_index == module_index) {
-			return hardware_handle_for_instance(kGnssUartPins[i].uart_instance);
+		RingBuffer *rb = &rx_rings[i];
+		uint32_t size = kRingSizes[i];
+		/* Round down to a power of two, then halve until it fits. */
+		while ((size & (size - 1u)) != 0) {
+			size &= size - 1u;
+		}
+		if (size > 32768u) {
+			size = 32768u;
 		}
+		if (size != 0 && size < RX_RING_MIN) {
+			size = RX_RING_MIN;
+		}
+		while (size >= RX_RING_MIN && used + size > sizeof(rx_arena)) {
+			size >>= 1;
+		}
+		if (size < RX_RING_MIN) {
+			size = 0;
+		}
+		rb->head = 0;
+		rb->tail = 0;
+		rb->reset_request = 0;
+		rb->reset_seen = 0;
+		rb->mask = (uint16_t)(size == 0 ? 0u : size - 1u);
+		rb->buffer = (size == 0) ? NULL : &rx_arena[used];
+		used += size;
 	}
-	return NULL;
 }
 
 void GnssUart_GpioInit(void) {
+	rx_arena_init();
+
 	__HAL_RCC_AFIO_CLK_ENABLE();
 	__HAL_RCC_GPIOA_CLK_ENABLE();
 	__HAL_RCC_GPIOB_CLK_ENABLE();
@@ -161,11 +463,14 @@ void GnssUart_GpioInit(void) {
 		gpio.Pull = GPIO_NOPULL;
 		HAL_GPIO_Init(pins->rx_port, &gpio);
 
-		/* TX: HW UART uses alternate function; otherwise default to GPIO output. */
+		/* TX: HW UART uses alternate function; software UART drives a GPIO output, idle high. */
+		if (pins->uart_instance == NULL) {
+			HAL_GPIO_WritePin(pins->tx_port, pins->tx_pin, GPIO_PIN_SET);
+		}
 		gpio.Pin = pins->tx_pin;
 		gpio.Pull = GPIO_NOPULL;
 		gpio.Speed = GPIO_SPEED_FREQ_HIGH;
-		gpio.Mode = (pins->uart_instance != NULL) ? GPIO_MODE_AF_PP : GPIO_MODE_INPUT;
+		gpio.Mode = (pins->uart_instance != NULL) ? GPIO_MODE_AF_PP : GPIO_MODE_OUTPUT_PP;
 		HAL_GPIO_Init(pins->tx_port, &gpio);
 	}
 }
@@ -199,6 +504,14 @@ void GnssUart_HardwareUartsInit(uint32_t baudrate) {
 	uart_init(&huart1, USART1, baudrate);
 	uart_init(&huart2, USART2, baudrate);
 	uart_init(&huart3, USART3, baudrate);
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (kGnssUartPins[i].uart_instance != NULL) {
+			module_baud[i] = baudrate;
+		}
+	}
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
 	HAL_NVIC_SetPriority(USART1_IRQn, 6, 0);
 	HAL_NVIC_EnableIRQ(USART1_IRQn);
@@ -206,180 +519,1721 @@ void GnssUart_HardwareUartsInit(uint32_t baudrate) {
 	HAL_NVIC_EnableIRQ(USART2_IRQn);
 	HAL_NVIC_SetPriority(USART3_IRQn, 6, 0);
 	HAL_NVIC_EnableIRQ(USART3_IRQn);
+
+	HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 6, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+	HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 6, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+	HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 6, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+}
+
+static void dma_rx_start(const UsartRxChannel *u) {
+	USART_TypeDef *instance = u->instance;
+	DMA_Channel_TypeDef *dma = u->dma;
+	RingBuffer *rb = u->rb;
+
+	dma->CCR &= ~DMA_CCR_EN;
+	if (rb->buffer == NULL) {
+		return;
+	}
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << u->dma_flag_shift);
+
+	/* The DMA restarts at the buffer base; the consumer drops what it had unread. */
+	*(volatile uint16_t *)&rb->head = 0;
+	__DMB();
+	rb->reset_request++;
+
+	dma->CPAR = (uint32_t)&instance->DR;
+	dma->CMAR = (uint32_t)rb->buffer;
+	dma->CNDTR = (uint32_t)rb->mask + 1u;
+	/* Peripheral -> memory, 8-bit, memory increment, circular, half/full transfer interrupts. */
+	dma->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_PL_1;
+	dma->CCR |= DMA_CCR_EN;
+
+	(void)instance->SR;
+	(void)instance->DR;
+	/* EIE: with DMAR set, ORE/FE/NE raise the USART interrupt so they can be counted. */
+	instance->CR3 |= USART_CR3_DMAR | USART_CR3_EIE;
+	instance->CR1 |= USART_CR1_IDLEIE;
 }
 
 void GnssUart_StartHardwareRx(void) {
-	(void)HAL_UART_Receive_IT(&huart1, &rx_byte_usart1, 1);
-	(void)HAL_UART_Receive_IT(&huart2, &rx_byte_usart2, 1);
-	(void)HAL_UART_Receive_IT(&huart3, &rx_byte_usart3, 1);
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	for (size_t i = 0; i < USART_RX_COUNT; i++) {
+		if (slot_active(kUsartRx[i].slot)) {
+			dma_rx_start(&kUsartRx[i]);
+		}
+	}
+}
+
+/* Publish everything the DMA has written so far as readable ring contents. */
+static void dma_rx_update_head(const UsartRxChannel *u) {
+	RingBuffer *rb = u->rb;
+	uint32_t mask = rb->mask;
+	uint32_t pos = (mask + 1u) - u->dma->CNDTR;
+	if (pos > mask) {
+		pos = 0;
+	}
+
+	/*
+	 * The DMA never stalls on a full ring, it overwrites unread bytes. Anything written beyond the
+	 * free space seen at the previous update is counted as dropped. Updates come at least every
+	 * half buffer, so a single wrap between them cannot go unseen.
+	 */
+	GnssUartStats *stats = &rx_stats[u->slot];
+	uint16_t old_head = rb->head;
+	uint16_t tail = *(volatile uint16_t *)&rb->tail;
+	if (*(volatile uint8_t *)&rb->reset_seen != rb->reset_request) {
+		tail = 0; /* The consumer has not caught up with a restart yet. */
+	}
+	uint32_t written = (pos - old_head) & mask;
+	uint32_t level = (old_head - tail) & mask;
+	uint32_t space = mask - level;
+	stats->bytes_received += written;
+	if (written > space) {
+		stats->ring_drops += written - space;
+		level = mask;
+	} else {
+		level += written;
+	}
+	if (level > stats->ring_high_water) {
+		stats->ring_high_water = (uint16_t)level;
+	}
+
+	__DMB();
+	*(volatile uint16_t *)&rb->head = (uint16_t)pos;
 }
 
-static void ring_push_byte(RingBuffer *rb, uint8_t byte) {
+static void ring_push_byte(RingBuffer *rb, GnssUartStats *stats, uint8_t byte) {
 	uint16_t head = rb->head;
-	uint16_t next = (uint16_t)((head + 1u) % (uint16_t)sizeof(rb->buffer));
-	if (next == rb->tail) {
+	uint16_t next = (uint16_t)((head + 1u) & rb->mask);
+	uint16_t tail = *(volatile uint16_t *)&rb->tail;
+	stats->bytes_received++;
+	if (next == tail) {
+		stats->ring_drops++;
 		return;
 	}
 	rb->buffer[head] = byte;
-	rb->head = next;
+	__DMB();
+	*(volatile uint16_t *)&rb->head = next;
+
+	uint16_t level = (uint16_t)((next - tail) & rb->mask);
+	if (level > stats->ring_high_water) {
+		stats->ring_high_water = level;
+	}
+}
+
+/*
+ * Longest contiguous run of unread bytes starting `offset` bytes past the tail. A producer restart
+ * seen here empties the ring from the consumer side; one that lands while `head` is being read
+ * reports nothing and is taken up on the next call.
+ */
+static size_t ring_peek(RingBuffer *rb, size_t offset, const uint8_t **data) {
+	uint8_t reset = rb->reset_request;
+	if (reset != rb->reset_seen) {
+		*(volatile uint16_t *)&rb->tail = 0;
+		__DMB();
+		*(volatile uint8_t *)&rb->reset_seen = reset;
+		rb->generation++;
+	}
+	__DMB();
+	uint16_t head = *(volatile uint16_t *)&rb->head;
+	__DMB();
+	*data = NULL;
+	if (rb->reset_request != reset) {
+		return 0;
+	}
+	uint32_t mask = rb->mask;
+	uint32_t available = (head - rb->tail) & mask;
+	if (rb->buffer == NULL || offset >= available) {
+		return 0;
+	}
+	uint32_t start = (rb->tail + offset) & mask;
+	*data = &rb->buffer[start];
+	uint32_t to_end = (mask + 1u) - start;
+	uint32_t remaining = available - (uint32_t)offset;
+	return (size_t)(remaining < to_end ? remaining : to_end);
+}
+
+static void ring_consume(RingBuffer *rb, size_t len) {
+	__DMB();
+	*(volatile uint16_t *)&rb->tail = (uint16_t)((rb->tail + len) & rb->mask);
+}
+
+/* Consumer side: discard everything unread, taking up a pending producer restart first. */
+static void ring_flush(RingBuffer *rb) {
+	const uint8_t *data;
+	(void)ring_peek(rb, 0, &data);
+	uint16_t head = *(volatile uint16_t *)&rb->head;
+	__DMB();
+	*(volatile uint16_t *)&rb->tail = head;
+	rb->generation++;
 }
 
 static size_t ring_pop_bytes(RingBuffer *rb, uint8_t *dst, size_t max_len) {
 	size_t count = 0;
-	while (count < max_len) {
-		uint16_t tail = rb->tail;
-		if (tail == rb->head) {
+	for (int segment = 0; segment < 2 && count < max_len; segment++) {
+		const uint8_t *data;
+		size_t n = ring_peek(rb, 0, &data);
+		if (n == 0) {
 			break;
 		}
-		dst[count++] = rb->buffer[tail];
-		rb->tail = (uint16_t)((tail + 1u) % (uint16_t)sizeof(rb->buffer));
+		if (n > max_len - count) {
+			n = max_len - count;
+		}
+		memcpy(&dst[count], data, n);
+		ring_consume(rb, n);
+		count += n;
 	}
 	return count;
 }
 
-size_t GnssUart_ReadBytes(uint8_t module_index, uint8_t *dst, size_t max_len) {
-	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
-	if (huart != NULL && huart->Instance != NULL) {
-		RingBuffer *rb = ring_for_instance(huart->Instance);
-		if (rb == NULL) {
-			return 0;
+static RingBuffer *ring_for_module(uint8_t module_index) {
+	const UsartRxChannel *u = usart_rx_for_module(module_index);
+	if (u != NULL) {
+		return u->rb;
+	}
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return NULL;
+	}
+	return &rx_rings[module_index - 1];
+}
+
+/*
+ * Restart a hardware channel's DMA reception. A transfer error disables the DMA channel, which
+ * would otherwise leave the module silent for good; unread bytes in the ring are discarded by the
+ * consumer on its next read. Runs from the DMA interrupt as well as the task.
+ */
+static void dma_rx_recover(const UsartRxChannel *u) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	dma_rx_start(u);
+	rx_stats[u->slot].rx_restarts++;
+	__set_PRIMASK(primask);
+}
+
+/* Take a hardware channel out of service: receiver, DMA and its interrupts all off. */
+static void dma_rx_stop(const UsartRxChannel *u) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	u->instance->CR1 &= ~(USART_CR1_RE | USART_CR1_IDLEIE);
+	u->instance->CR3 &= ~(USART_CR3_DMAR | USART_CR3_EIE);
+	u->dma->CCR &= ~DMA_CCR_EN;
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << u->dma_flag_shift);
+	/* DMA is off and this is the consumer's context, so both indices can go back together. */
+	u->rb->head = 0;
+	u->rb->tail = 0;
+	u->rb->reset_seen = u->rb->reset_request;
+	u->rb->generation++;
+	__set_PRIMASK(primask);
+}
+
+/*
+ * Task-side receive housekeeping before a read: hardware channels re-arm DMA if it has stopped
+ * for any reason, capture channels rebuild bytes from the edges queued since the last read.
+ */
+static void rx_service_module(uint8_t module_index) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT || !slot_active(module_index - 1u)) {
+		return;
+	}
+	const UsartRxChannel *u = usart_rx_for_module(module_index);
+	if (u != NULL) {
+		bool stopped = (u->dma->CCR & DMA_CCR_EN) == 0 || (u->instance->CR3 & USART_CR3_DMAR) == 0;
+		if (stopped && u->rb->buffer != NULL) {
+			dma_rx_recover(u);
 		}
-		return ring_pop_bytes(rb, dst, max_len);
+		return;
+	}
+	CaptureRxChannel *capture = capture_for_slot(module_index - 1u);
+	if (capture != NULL) {
+		capture_rx_poll(capture);
+	}
+}
+
+size_t GnssUart_ReadBytes(uint8_t module_index, uint8_t *dst, size_t max_len) {
+	RingBuffer *rb = ring_for_module(module_index);
+	if (rb == NULL) {
+		return 0;
 	}
+	rx_service_module(module_index);
+	return ring_pop_bytes(rb, dst, max_len);
+}
 
-	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+size_t GnssUart_Peek(uint8_t module_index, size_t offset, const uint8_t **data) {
+	RingBuffer *rb = ring_for_module(module_index);
+	if (rb == NULL) {
+		*data = NULL;
 		return 0;
 	}
-	return ring_pop_bytes(&soft_channels[module_index - 1].rb, dst, max_len);
+	rx_service_module(module_index);
+	return ring_peek(rb, offset, data);
 }
 
-void GnssUart_IrqHandler(USART_TypeDef *instance) {
-	UART_HandleTypeDef *huart = hardware_handle_for_instance(instance);
-	if (huart == NULL) {
-		return;
+void GnssUart_Consume(uint8_t module_index, size_t len) {
+	RingBuffer *rb = ring_for_module(module_index);
+	if (rb != NULL && len > 0) {
+		ring_consume(rb, len);
+	}
+}
+
+uint8_t GnssUart_RxGeneration(uint8_t module_index) {
+	RingBuffer *rb = ring_for_module(module_index);
+	return (rb != NULL) ? rb->generation : 0u;
+}
+
+/* Receive interrupt cost in CPU cycles, from DWT->CYCCNT (enabled in GnssUart_HardwareUartsInit). */
+static void isr_cycles_note(GnssUartStats *stats, uint32_t start) {
+	uint32_t cycles = DWT->CYCCNT - start;
+	if (cycles > stats->isr_cycles_max) {
+		stats->isr_cycles_max = cycles;
 	}
-	HAL_UART_IRQHandler(huart);
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-	if (huart == NULL || huart->Instance == NULL) {
+void GnssUart_IrqHandler(GnssUartRxChannel channel) {
+	uint32_t start = DWT->CYCCNT;
+	if ((uint32_t)channel >= USART_RX_COUNT) {
 		return;
 	}
-	RingBuffer *rb = ring_for_instance(huart->Instance);
-	uint8_t *byte = rx_byte_for_instance(huart->Instance);
-	if (rb == NULL || byte == NULL) {
+	const UsartRxChannel *u = &kUsartRx[channel];
+	USART_TypeDef *instance = u->instance;
+	uint32_t sr = instance->SR;
+	if ((sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE | USART_SR_NE)) == 0) {
 		return;
 	}
-	ring_push_byte(rb, *byte);
-	(void)HAL_UART_Receive_IT(huart, byte, 1);
+
+	/* IDLE and the error flags are all cleared by the SR read above followed by a DR read. */
+	(void)instance->DR;
+	GnssUartStats *stats = &rx_stats[u->slot];
+	if ((sr & USART_SR_ORE) != 0) {
+		stats->overruns++;
+	}
+	if ((sr & USART_SR_FE) != 0) {
+		stats->framing_errors++;
+	}
+	if ((sr & USART_SR_NE) != 0) {
+		stats->noise_errors++;
+	}
+	if ((sr & USART_SR_IDLE) != 0) {
+		dma_rx_update_head(u);
+	}
+	isr_cycles_note(stats, start);
 }
 
-static bool read_pin(GPIO_TypeDef *port, uint16_t pin) {
-	return (port->IDR & pin) != 0;
+void GnssUart_DmaIrqHandler(GnssUartRxChannel channel) {
+	uint32_t start = DWT->CYCCNT;
+	if ((uint32_t)channel >= USART_RX_COUNT) {
+		return;
+	}
+	const UsartRxChannel *u = &kUsartRx[channel];
+	uint32_t shift = u->dma_flag_shift;
+	uint32_t flags = (DMA1->ISR >> shift) & (DMA_ISR_HTIF1 | DMA_ISR_TCIF1 | DMA_ISR_TEIF1);
+	DMA1->IFCR = (DMA_IFCR_CGIF1 << shift);
+	if ((flags & DMA_ISR_TEIF1) != 0) {
+		dma_rx_recover(u);
+	} else if (flags != 0) {
+		dma_rx_update_head(u);
+	}
+	isr_cycles_note(&rx_stats[u->slot], start);
 }
 
-static void soft_uart_tick(void) {
-	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
-		const GnssUartPins *pins = &kGnssUartPins[i];
-		if (pins->uart_instance != NULL) {
-			continue;
-		}
+static uint32_t sample_bit_for_pin(GPIO_TypeDef *port, uint16_t pin) {
+	uint32_t bit = 0;
+	while (bit < 16u && ((uint32_t)pin & (1u << bit)) == 0) {
+		bit++;
+	}
+	if (bit >= 16u) {
+		return 32u;
+	}
+	if (port == GPIOA) {
+		return bit;
+	}
+	if (port == GPIOB) {
+		return 16u + bit;
+	}
+	return 32u;
+}
 
-		SoftUartChannel *ch = &soft_channels[i];
-		bool level = read_pin(pins->rx_port, pins->rx_pin);
+/* Load each channel's reload value from `planes` into the phase counter of every channel in `mask`. */
+static void phase_load(SoftUartDecoder *d, uint32_t mask, const uint32_t *planes) {
+	for (uint32_t k = 0; k < d->phase_bits; k++) {
+		d->phase[k] = (d->phase[k] & ~mask) | (planes[k] & mask);
+	}
+}
 
-		switch (ch->state) {
-		case SOFT_RX_IDLE:
-			if (!level) {
-				ch->state = SOFT_RX_START;
-				ch->sub_tick = 0;
-			}
-			break;
-		case SOFT_RX_START:
-			ch->sub_tick++;
-			if (ch->sub_tick == 4) {
-				if (!level) {
-					ch->state = SOFT_RX_DATA;
-					ch->sub_tick = 0;
-					ch->bit_index = 0;
-					ch->byte = 0;
-				} else {
-					ch->state = SOFT_RX_IDLE;
-				}
-			}
-			break;
-		case SOFT_RX_DATA:
-			ch->sub_tick++;
-			if (ch->sub_tick == 8) {
-				if (level) {
-					ch->byte |= (uint8_t)(1u << ch->bit_index);
-				}
-				ch->bit_index++;
-				ch->sub_tick = 0;
-				if (ch->bit_index >= 8) {
-					ch->state = SOFT_RX_STOP;
+static void soft_uart_sample_point(SoftUartDecoder *d, uint32_t bit, bool level) {
+	uint32_t channel_bit = 1u << bit;
+	SoftUartChannel *ch = &soft_channels[d->slot_for_bit[bit]];
+
+	if (ch->bit_index == SOFT_UART_FRAME_START) {
+		if (level) {
+			/* Glitch, not a start bit. */
+			rx_stats[d->slot_for_bit[bit]].noise_errors++;
+			d->busy &= ~channel_bit;
+			return;
+		}
+		ch->byte = 0;
+	} else if (ch->bit_index < SOFT_UART_FRAME_STOP) {
+		if (level) {
+			ch->byte |= (uint8_t)(1u << (ch->bit_index - 1u));
+		}
+	} else {
+		if (level) {
+			ring_push_byte(&rx_rings[d->slot_for_bit[bit]], &rx_stats[d->slot_for_bit[bit]], ch->byte);
+		} else {
+			rx_stats[d->slot_for_bit[bit]].framing_errors++;
+		}
+		d->busy &= ~channel_bit;
+		d->at_stop &= ~channel_bit;
+		return;
+	}
+	ch->bit_index++;
+	if (ch->bit_index == SOFT_UART_FRAME_STOP) {
+		d->at_stop |= channel_bit;
+	}
+}
+
+static void autobaud_edge(AutoBaud *ab, uint32_t time, uint32_t time_mask) {
+	if (ab->have_edge) {
+		uint32_t width = (time - ab->last_edge) & time_mask;
+		if (width >= ab->glitch_width) {
+			if (width < ab->short_widths[AUTOBAUD_SHORT_PULSES - 1u]) {
+				size_t i = AUTOBAUD_SHORT_PULSES - 1u;
+				while (i > 0 && ab->short_widths[i - 1u] > width) {
+					ab->short_widths[i] = ab->short_widths[i - 1u];
+					i--;
 				}
+				ab->short_widths[i] = width;
 			}
-			break;
-		case SOFT_RX_STOP:
-			ch->sub_tick++;
-			if (ch->sub_tick == 8) {
-				if (level) {
-					ring_push_byte(&ch->rb, ch->byte);
-				}
-				ch->state = SOFT_RX_IDLE;
-				ch->sub_tick = 0;
+			if (ab->pulses < 0xFFFFu) {
+				ab->pulses++;
 			}
-			break;
-		default:
-			ch->state = SOFT_RX_IDLE;
-			ch->sub_tick = 0;
-			break;
 		}
 	}
+	ab->last_edge = time;
+	ab->have_edge = true;
 }
 
-void GnssUart_SoftUartInit(uint32_t baudrate) {
-	memset(soft_channels, 0, sizeof(soft_channels));
+static void soft_uart_autobaud_edges(SoftUartDecoder *d, uint32_t sample) {
+	uint32_t edges = (sample ^ d->autobaud_last) & d->autobaud_mask;
+	d->autobaud_last = sample;
+	while (edges != 0) {
+		uint32_t bit = 31u - __CLZ(edges);
+		edges &= ~(1u << bit);
+		autobaud_edge(&autobaud[d->slot_for_bit[bit]], d->tick, ~0u);
+	}
+}
 
-	__HAL_RCC_TIM2_CLK_ENABLE();
+static void soft_uart_tick(uint32_t sample) {
+	SoftUartDecoder *d = &soft_decoder;
 
-	uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
-	uint32_t tim_clk = pclk1;
-	uint32_t ppre1 = (RCC->CFGR & RCC_CFGR_PPRE1);
-	if (ppre1 != RCC_CFGR_PPRE1_DIV1) {
-		tim_clk = pclk1 * 2u;
+	d->tick++;
+	if (d->autobaud_mask != 0) {
+		soft_uart_autobaud_edges(d, sample);
 	}
 
-	uint32_t base_hz = 1000000u;
-	uint32_t prescaler = (tim_clk / base_hz);
-	if (prescaler == 0) {
-		prescaler = 1;
+	/* Majority of this and the two previous samples: the level one tick ago, with glitches voted out. */
+	uint32_t prev1 = d->history[0];
+	uint32_t prev2 = d->history[1];
+	uint32_t vote = (sample & prev1) | (sample & prev2) | (prev1 & prev2);
+	uint32_t fall = d->busy & prev1 & ~sample;
+	d->history[1] = prev1;
+	d->history[0] = sample;
+
+	/* Channels whose phase counter reached zero sample now; the rest count down. */
+	uint32_t zero = ~0u;
+	for (uint32_t k = 0; k < d->phase_bits; k++) {
+		zero &= ~d->phase[k];
+	}
+	uint32_t due = d->busy & zero;
+	uint32_t borrow = d->busy & ~due;
+	for (uint32_t k = 0; k < d->phase_bits; k++) {
+		uint32_t plane = d->phase[k];
+		d->phase[k] = plane ^ borrow;
+		borrow &= ~plane;
 	}
-	prescaler -= 1u;
 
-	uint32_t tick_hz = baudrate * 8u;
-	uint32_t period = (base_hz + (tick_hz / 2u)) / tick_hz;
-	if (period == 0) {
-		period = 1;
+	if (due != 0) {
+		phase_load(d, due, d->bit_reload);
+		uint32_t pending = due;
+		while (pending != 0) {
+			uint32_t bit = 31u - __CLZ(pending);
+			pending &= ~(1u << bit);
+			soft_uart_sample_point(d, bit, (vote & (1u << bit)) != 0);
+		}
 	}
-	period -= 1u;
 
-	HAL_NVIC_SetPriority(TIM2_IRQn, 6, 0);
-	HAL_NVIC_EnableIRQ(TIM2_IRQn);
+	/*
+	 * A falling edge inside a frame starts a bit: re-centre that channel on it, like a start bit.
+	 * While waiting for the stop bit it can only be the next start bit from a slightly fast
+	 * sender, arriving before the stop bit's vote point: the line was high, so the byte is good.
+	 */
+	uint32_t resync = fall & d->busy & ~due;
+	if (resync != 0) {
+		phase_load(d, resync, d->start_reload);
+		uint32_t early = resync & d->at_stop;
+		d->at_stop &= ~early;
+		d->activity |= early;
+		while (early != 0) {
+			uint32_t bit = 31u - __CLZ(early);
+			early &= ~(1u << bit);
+			SoftUartChannel *ch = &soft_channels[d->slot_for_bit[bit]];
+			ring_push_byte(&rx_rings[d->slot_for_bit[bit]], &rx_stats[d->slot_for_bit[bit]], ch->byte);
+			ch->bit_index = SOFT_UART_FRAME_START;
+		}
+	}
 
-	TIM2->PSC = (uint16_t)(prescaler > 0xFFFFu ? 0xFFFFu : prescaler);
-	TIM2->ARR = (uint16_t)(period > 0xFFFFu ? 0xFFFFu : period);
-	TIM2->CNT = 0;
-	TIM2->EGR = TIM_EGR_UG;
-	TIM2->SR = 0;
-	TIM2->DIER |= TIM_DIER_UIE;
+	/*
+	 * Idle channels seeing a low level start a frame; first vote point is mid start bit. Channels
+	 * that took their stop sample this tick are idle again already, so back-to-back frames from a
+	 * fast sender do not lose a tick of start bit.
+	 */
+	uint32_t start = d->rx_mask & ~d->busy & ~sample;
+	if (start != 0) {
+		phase_load(d, start, d->start_reload);
+		d->busy |= start;
+		d->activity |= start;
+		uint32_t pending = start;
+		while (pending != 0) {
+			uint32_t bit = 31u - __CLZ(pending);
+			pending &= ~(1u << bit);
+			soft_channels[d->slot_for_bit[bit]].bit_index = SOFT_UART_FRAME_START;
+		}
+	}
+}
+
+/* One channel's value out of a set of bit planes. */
+static uint32_t plane_value(const uint32_t *planes, uint32_t bit) {
+	uint32_t value = 0;
+	for (uint32_t k = 0; k < SOFT_UART_PHASE_BITS_MAX; k++) {
+		value |= ((planes[k] >> bit) & 1u) << k;
+	}
+	return value;
+}
+
+/*
+ * Take soft_timing_next's reloads into the decoder, from the first sample at the new rate.
+ * Channels whose bit time is unchanged keep counting; a frame in flight on a channel whose bit
+ * time changed keeps its place in the current bit, its ticks left scaled to the new bit time.
+ */
+static void soft_uart_decoder_retime(SoftUartDecoder *d) {
+	const SoftUartTiming *t = &soft_timing_next;
+	uint32_t changed = 0;
+	for (uint32_t k = 0; k < SOFT_UART_PHASE_BITS_MAX; k++) {
+		changed |= (d->bit_reload[k] ^ t->bit_reload[k]) | (d->start_reload[k] ^ t->start_reload[k]);
+	}
+
+	uint32_t carried = d->busy & changed;
+	while (carried != 0) {
+		uint32_t bit = 31u - __CLZ(carried);
+		carried &= ~(1u << bit);
+		uint32_t old_ticks = plane_value(d->bit_reload, bit) + 1u;
+		uint32_t new_reload = plane_value(t->bit_reload, bit);
+		if (new_reload == 0) {
+			d->busy &= ~(1u << bit);
+			d->at_stop &= ~(1u << bit);
+			continue;
+		}
+		uint32_t left = (plane_value(d->phase, bit) * (new_reload + 1u) + (old_ticks / 2u)) / old_ticks;
+		if (left > new_reload) {
+			left = new_reload;
+		}
+		for (uint32_t k = 0; k < SOFT_UART_PHASE_BITS_MAX; k++) {
+			d->phase[k] = (d->phase[k] & ~(1u << bit)) | (((left >> k) & 1u) << bit);
+		}
+	}
+
+	for (uint32_t k = 0; k < SOFT_UART_PHASE_BITS_MAX; k++) {
+		d->bit_reload[k] = t->bit_reload[k];
+		d->start_reload[k] = t->start_reload[k];
+	}
+	d->phase_bits = t->phase_bits;
+
+	/* Channels starting auto-baud time edges from the last sample taken at the old rate. */
+	d->autobaud_mask = t->autobaud_mask & d->autobaud_request;
+	d->autobaud_last = d->history[0];
+	d->retime_armed = false;
+}
+
+/* Decode the half-buffer starting at sample `first`, switching timing where TIM2 did. */
+static void soft_uart_decode_block(size_t first) {
+	SoftUartDecoder *d = &soft_decoder;
+	size_t end = first + GNSS_SOFT_UART_SAMPLE_BLOCK;
+	for (size_t i = first; i < end; i++) {
+		if (d->retime_armed && d->retime_at == i) {
+			soft_uart_decoder_retime(d);
+		}
+		soft_uart_tick(((uint32_t)soft_samples_b[i] << 16) | soft_samples_a[i]);
+	}
+}
+
+static uint32_t soft_uart_pins_now(void) {
+	return ((uint32_t)GPIOB->IDR << 16) | (GPIOA->IDR & 0xFFFFu);
+}
+
+static void soft_uart_sampling_start(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	EXTI->IMR &= ~d->exti_mask;
+	EXTI->PR = d->exti_mask;
+	d->sampling = true;
 	TIM2->CR1 |= TIM_CR1_CEN;
 }
 
-void GnssUart_TimIrqHandler(void) {
-	if ((TIM2->SR & TIM_SR_UIF) != 0) {
-		TIM2->SR &= ~TIM_SR_UIF;
-		soft_uart_tick();
+/*
+ * True if any RX line was low in the samples the DMA has stored from `from` up to its current
+ * position, i.e. those taken since the half-buffer that was just decoded.
+ */
+static bool soft_uart_undecoded_low(size_t from) {
+	const size_t ring = 2u * GNSS_SOFT_UART_SAMPLE_BLOCK;
+	size_t to = ring - DMA1_Channel1->CNDTR;
+	uint32_t rx_mask = soft_decoder.rx_mask;
+	for (size_t i = from; i != to; i = (i + 1u == ring) ? 0 : i + 1u) {
+		uint32_t sample = ((uint32_t)soft_samples_b[i] << 16) | soft_samples_a[i];
+		if ((~sample & rx_mask) != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Park TIM2 (and with it the sampling DMA) and wait for a start bit on EXTI. The DMA position is
+ * kept, so samples taken after the next start simply continue the current half-buffer.
+ * `decoded_end` is the sample index just past the half that was decoded.
+ */
+static void soft_uart_sampling_stop(size_t decoded_end) {
+	SoftUartDecoder *d = &soft_decoder;
+	if (soft_tx_active == 0) {
+		TIM2->CR1 &= ~TIM_CR1_CEN;
+	}
+	d->sampling = false;
+	EXTI->PR = d->exti_mask;
+	EXTI->IMR |= d->exti_mask;
+
+	/*
+	 * A start bit that began after the last decoded sample has no edge left to trigger on: the
+	 * interrupt latency and the decode itself span about 11 bit times at 115200, so the line may
+	 * already be back high. Keep sampling if the undecoded samples or the pins show a low level.
+	 */
+	if (soft_uart_undecoded_low(decoded_end) || (soft_uart_pins_now() & d->rx_mask) != d->rx_mask) {
+		soft_uart_sampling_start();
+	}
+}
+
+/* Route the EXTI line of a sample bit (see sample_bit_for_pin) to its port; returns the line. */
+static uint32_t exti_route(uint32_t bit) {
+	uint32_t line = bit & 15u;
+	uint32_t port_code = (bit >= 16u) ? 1u : 0u; /* 0 = GPIOA, 1 = GPIOB */
+	uint32_t shift = (line & 3u) * 4u;
+	AFIO->EXTICR[line >> 2] = (AFIO->EXTICR[line >> 2] & ~(0xFu << shift)) | (port_code << shift);
+	return line;
+}
+
+static void exti_irq_enable(uint32_t line) {
+	IRQn_Type irq;
+	if (line <= 4u) {
+		irq = (IRQn_Type)(EXTI0_IRQn + (int32_t)line);
+	} else if (line <= 9u) {
+		irq = EXTI9_5_IRQn;
+	} else {
+		irq = EXTI15_10_IRQn;
+	}
+	HAL_NVIC_SetPriority(irq, GNSS_UART_EXTI_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(irq);
+}
+
+static void soft_uart_exti_init(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	d->exti_mask = 0;
+
+	for (uint32_t bit = 0; bit < 32u; bit++) {
+		if ((d->rx_mask & (1u << bit)) == 0) {
+			continue;
+		}
+		d->exti_mask |= (1u << exti_route(bit));
+	}
+
+	EXTI->IMR &= ~d->exti_mask;
+	EXTI->EMR &= ~d->exti_mask;
+	EXTI->RTSR &= ~d->exti_mask;
+	EXTI->FTSR |= d->exti_mask;
+	EXTI->PR = d->exti_mask;
+
+	for (uint32_t line = 0; line < 16u; line++) {
+		if ((d->exti_mask & (1u << line)) != 0) {
+			exti_irq_enable(line);
+		}
+	}
+}
+
+/*
+ * Hardware auto-baud edges, stamped on entry. A pin found back at the level of the previous edge
+ * means two edges fell inside one interrupt latency, so the pulse between them is dropped. Each
+ * line masks itself once its channel has enough pulses.
+ */
+static void autobaud_exti_edges(uint32_t pending) {
+	uint32_t now = DWT->CYCCNT;
+	for (uint32_t line = 0; pending != 0; line++) {
+		if ((pending & (1u << line)) == 0) {
+			continue;
+		}
+		pending &= ~(1u << line);
+		size_t slot = autobaud_exti_slot[line];
+		const GnssUartPins *pins = &kGnssUartPins[slot];
+		AutoBaud *ab = &autobaud[slot];
+		uint8_t level = (pins->rx_port->IDR & pins->rx_pin) != 0 ? 1u : 0u;
+		if (level == ab->level) {
+			ab->have_edge = false;
+			continue;
+		}
+		ab->level = level;
+		autobaud_edge(ab, now, ~0u);
+		if (ab->pulses >= GNSS_AUTOBAUD_MIN_PULSES) {
+			EXTI->IMR &= ~(1u << line);
+			autobaud_exti_mask &= ~(1u << line);
+		}
+	}
+}
+
+void GnssUart_ExtiIrqHandler(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	uint32_t timed = EXTI->PR & autobaud_exti_mask;
+	if (timed != 0) {
+		EXTI->PR = timed;
+		autobaud_exti_edges(timed);
+	}
+
+	uint32_t pending = EXTI->PR & d->exti_mask;
+	if (pending == 0) {
+		return;
+	}
+	EXTI->PR = pending;
+	if (!d->sampling) {
+		soft_uart_sampling_start();
+	}
+}
+
+static void sample_dma_start(DMA_Channel_TypeDef *dma, GPIO_TypeDef *port, uint16_t *dst, uint32_t ccr_irq) {
+	dma->CCR &= ~DMA_CCR_EN;
+	dma->CPAR = (uint32_t)&port->IDR;
+	dma->CMAR = (uint32_t)dst;
+	dma->CNDTR = 2u * GNSS_SOFT_UART_SAMPLE_BLOCK;
+	/* GPIO registers only accept word access: 32-bit peripheral reads packed into 16-bit samples. */
+	dma->CCR = DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_0 | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_PL_0 |
+	           DMA_CCR_PL_1 | ccr_irq;
+	dma->CCR |= DMA_CCR_EN;
+}
+
+static void soft_uart_tx_tick(void) {
+	uint8_t active = soft_tx_active;
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if ((active & (1u << i)) == 0) {
+			continue;
+		}
+		SoftUartTx *tx = &soft_channels[i].tx;
+		if (tx->ticks_left > 1u) {
+			tx->ticks_left--;
+			continue;
+		}
+		tx->ticks_left = tx->ticks_per_bit;
+
+		if (tx->bits_left == 0) {
+			uint16_t tail = tx->tail;
+			if (tail == tx->head) {
+				/* Stop bit has been on the line for a full bit time. */
+				active &= (uint8_t)~(1u << i);
+				continue;
+			}
+			tx->frame = (uint16_t)(((uint16_t)tx->buffer[tail] << 1) | 0x200u);
+			tx->bits_left = 10u;
+			tx->tail = (uint16_t)((tail + 1u) % GNSS_SOFT_UART_TX_RING_SIZE);
+		}
+
+		const GnssUartPins *pins = &kGnssUartPins[i];
+		if ((tx->frame & 1u) != 0) {
+			pins->tx_port->BSRR = pins->tx_pin;
+		} else {
+			pins->tx_port->BSRR = (uint32_t)pins->tx_pin << 16;
+		}
+		tx->frame >>= 1;
+		tx->bits_left--;
+	}
+
+	soft_tx_active = active;
+	if (active == 0) {
+		TIM1->DIER &= ~TIM_DIER_UIE;
+		if (!soft_decoder.sampling) {
+			TIM2->CR1 &= ~TIM_CR1_CEN;
+		}
+	}
+}
+
+void GnssUart_TimIrqHandler(void) {
+	if ((TIM1->SR & TIM_SR_UIF) != 0) {
+		TIM1->SR = ~TIM_SR_UIF;
+		soft_uart_tx_tick();
+	}
+}
+
+static size_t soft_uart_write(size_t slot, const uint8_t *data, size_t len) {
+	SoftUartTx *tx = &soft_channels[slot].tx;
+
+	size_t count = 0;
+	while (count < len) {
+		uint16_t head = tx->head;
+		uint16_t next = (uint16_t)((head + 1u) % GNSS_SOFT_UART_TX_RING_SIZE);
+		if (next == tx->tail) {
+			break;
+		}
+		tx->buffer[head] = data[count++];
+		tx->head = next;
+	}
+
+	if (count > 0) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		if ((soft_tx_active & (1u << slot)) == 0) {
+			tx->bits_left = 0;
+			tx->ticks_left = 1;
+			soft_tx_active |= (uint8_t)(1u << slot);
+		}
+		TIM1->SR = ~TIM_SR_UIF;
+		TIM1->DIER |= TIM_DIER_UIE;
+		TIM2->CR1 |= TIM_CR1_CEN;
+		__set_PRIMASK(primask);
+	}
+	return count;
+}
+
+size_t GnssUart_Write(uint8_t module_index, const uint8_t *data, size_t len) {
+	if (data == NULL || len == 0 || module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return 0;
+	}
+
+	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
+	if (huart != NULL && huart->Instance != NULL) {
+		if (len > 0xFFFFu) {
+			len = 0xFFFFu;
+		}
+		uint32_t baud = huart->Init.BaudRate == 0 ? 9600u : huart->Init.BaudRate;
+		uint32_t timeout_ms = (uint32_t)((len * 10000u) / baud) + 10u;
+		if (HAL_UART_Transmit(huart, (uint8_t *)data, (uint16_t)len, timeout_ms) != HAL_OK) {
+			return 0;
+		}
+		return len;
+	}
+
+	return soft_uart_write(module_index - 1u, data, len);
+}
+
+bool GnssUart_TxBusy(uint8_t module_index) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return false;
+	}
+	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
+	if (huart != NULL && huart->Instance != NULL) {
+		return (huart->Instance->SR & USART_SR_TC) == 0;
+	}
+	return (soft_tx_active & (1u << (module_index - 1u))) != 0;
+}
+
+static uint32_t apb1_timer_clock(void) {
+	uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+	uint32_t ppre1 = (RCC->CFGR & RCC_CFGR_PPRE1);
+	if (ppre1 != RCC_CFGR_PPRE1_DIV1) {
+		return pclk1 * 2u;
+	}
+	return pclk1;
+}
+
+static CaptureRxChannel *capture_for_slot(size_t slot) {
+	for (size_t i = 0; i < capture_channel_count; i++) {
+		if (capture_channels[i].slot == slot) {
+			return &capture_channels[i];
+		}
+	}
+	return NULL;
+}
+
+static volatile uint32_t *capture_ccr(TIM_TypeDef *timer, uint8_t channel) {
+	return &(&timer->CCR1)[channel - 1u];
+}
+
+static uint32_t capture_ccer_shift(uint8_t channel) {
+	return 4u * (uint32_t)(channel - 1u);
+}
+
+static bool time_reached(uint32_t now, uint32_t t) {
+	return ((now - t) & CAPTURE_TIME_MASK) < (CAPTURE_TIME_MASK / 2u);
+}
+
+static void capture_queue_edge(CaptureRxChannel *c, uint32_t time, uint8_t level) {
+	uint16_t head = c->edge_head;
+	uint16_t next = (uint16_t)((head + 1u) % GNSS_CAPTURE_EDGE_RING);
+	if (next == c->edge_tail) {
+		return;
+	}
+	uint32_t delta = (time - c->edge_last) & CAPTURE_TIME_MASK;
+	if (delta > CAPTURE_DELTA_MAX) {
+		delta = CAPTURE_DELTA_MAX;
+	}
+	c->edges[head] = (uint16_t)((delta << 1) | level);
+	c->edge_last = time & CAPTURE_TIME_MASK;
+	c->edge_head = next;
+}
+
+static void capture_channel_irq(CaptureRxChannel *c, uint32_t sr) {
+	TIM_TypeDef *timer = c->timer;
+	uint32_t ccif = TIM_SR_CC1IF << (c->channel - 1u);
+	if ((sr & ccif) == 0) {
+		return;
+	}
+
+	/* Reading CCRx clears CCxIF. A capture taken just after a pending wrap belongs to the next period. */
+	uint32_t ccr = *capture_ccr(timer, c->channel);
+	uint32_t high = c->overflow;
+	if ((sr & TIM_SR_UIF) != 0 && ccr < 0x8000u) {
+		high++;
+	}
+	uint32_t time = (high << 16) | ccr;
+
+	uint32_t ccxp = TIM_CCER_CC1P << capture_ccer_shift(c->channel);
+	uint8_t level = ((timer->CCER & ccxp) != 0) ? 0u : 1u;
+	capture_queue_edge(c, time, level);
+
+	timer->CCER ^= ccxp;
+	timer->SR = ~(TIM_SR_CC1OF << (c->channel - 1u));
+
+	/* If the opposite edge already happened while re-arming, record it rather than losing sync. */
+	uint8_t pin_level = ((c->rx_port->IDR & c->rx_pin) != 0) ? 1u : 0u;
+	if (pin_level != level) {
+		capture_queue_edge(c, (high << 16) | (timer->CNT & 0xFFFFu), pin_level);
+		timer->CCER ^= ccxp;
+	}
+}
+
+void GnssUart_CaptureIrqHandler(TIM_TypeDef *timer) {
+	uint32_t sr = timer->SR;
+
+	for (size_t i = 0; i < capture_channel_count; i++) {
+		if (capture_channels[i].timer == timer) {
+			capture_channel_irq(&capture_channels[i], sr);
+		}
+	}
+
+	if ((sr & TIM_SR_UIF) != 0) {
+		timer->SR = ~TIM_SR_UIF;
+		for (size_t i = 0; i < capture_channel_count; i++) {
+			if (capture_channels[i].timer == timer) {
+				capture_channels[i].overflow++;
+			}
+		}
+	}
+}
+
+static uint32_t capture_now(CaptureRxChannel *c) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t high = c->overflow;
+	uint32_t cnt = c->timer->CNT & 0xFFFFu;
+	if ((c->timer->SR & TIM_SR_UIF) != 0 && cnt < 0x8000u) {
+		high++;
+	}
+	__set_PRIMASK(primask);
+	return ((high << 16) | cnt) & CAPTURE_TIME_MASK;
+}
+
+/* Resolve every bit of the current frame whose centre lies before `until` at the current level. */
+static void capture_rx_resolve(CaptureRxChannel *c, uint32_t until) {
+	while (c->in_frame) {
+		uint32_t centre = c->frame_start + ((((uint32_t)c->bit_index * 2u) + 1u) * c->bit_ticks_q8 >> 9);
+		if (!time_reached(until, centre & CAPTURE_TIME_MASK)) {
+			return;
+		}
+		if (c->bit_index == SOFT_UART_FRAME_START) {
+			if (c->level != 0) {
+				rx_stats[c->slot].noise_errors++;
+				c->in_frame = false;
+				return;
+			}
+		} else if (c->bit_index < SOFT_UART_FRAME_STOP) {
+			if (c->level != 0) {
+				c->byte |= (uint8_t)(1u << (c->bit_index - 1u));
+			}
+		} else {
+			if (c->level != 0) {
+				ring_push_byte(&rx_rings[c->slot], &rx_stats[c->slot], c->byte);
+			} else {
+				rx_stats[c->slot].framing_errors++;
+			}
+			c->in_frame = false;
+			return;
+		}
+		c->bit_index++;
+	}
+}
+
+static void capture_rx_poll(CaptureRxChannel *c) {
+	/* Take "now" with the queue head and the newest edge time; later edges wait for the next poll. */
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t now = capture_now(c);
+	uint16_t head = c->edge_head;
+	uint32_t last = c->edge_last;
+	__set_PRIMASK(primask);
+
+	while (c->edge_tail != head) {
+		uint16_t edge = c->edges[c->edge_tail];
+		c->edge_tail = (uint16_t)((c->edge_tail + 1u) % GNSS_CAPTURE_EDGE_RING);
+
+		uint32_t time = (c->edge_time + (uint32_t)(edge >> 1)) & CAPTURE_TIME_MASK;
+		c->edge_time = time;
+		if (autobaud[c->slot].active) {
+			autobaud_edge(&autobaud[c->slot], time, CAPTURE_TIME_MASK);
+		}
+		capture_rx_resolve(c, time);
+		c->level = (uint8_t)(edge & 1u);
+		if (!c->in_frame && c->level == 0) {
+			c->in_frame = true;
+			c->frame_start = time;
+			c->bit_index = SOFT_UART_FRAME_START;
+			c->byte = 0;
+		}
+	}
+
+	/*
+	 * A saturated gap leaves the rebuilt times short of the real ones. The line was idle for the whole
+	 * gap, so frames before it are already closed; shift the frame in flight onto the real time base.
+	 */
+	uint32_t offset = (last - c->edge_time) & CAPTURE_TIME_MASK;
+	c->frame_start = (c->frame_start + offset) & CAPTURE_TIME_MASK;
+	c->edge_time = last;
+
+	/* Trailing high bits (and the stop bit) produce no edge; close the frame once time has passed. */
+	capture_rx_resolve(c, now);
+}
+
+static uint32_t capture_tick_hz;
+
+/*
+ * Arm a capture channel for the edge that leaves the current level, or park it with its interrupt
+ * off. The timer's overflow interrupt only runs while some channel on it is armed.
+ */
+static void capture_rx_arm(CaptureRxChannel *c, bool enable) {
+	TIM_TypeDef *timer = c->timer;
+	uint32_t ccer_shift = capture_ccer_shift(c->channel);
+	uint32_t ccie = TIM_DIER_CC1IE << (c->channel - 1u);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	timer->DIER &= ~ccie;
+	timer->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P) << ccer_shift);
+	c->edge_tail = c->edge_head;
+	c->edge_last = capture_now(c);
+	c->edge_time = c->edge_last;
+	c->in_frame = false;
+	if (enable) {
+		c->level = ((c->rx_port->IDR & c->rx_pin) != 0) ? 1u : 0u;
+		if (c->level != 0) {
+			timer->CCER |= (TIM_CCER_CC1P << ccer_shift);
+		}
+		timer->CCER |= (TIM_CCER_CC1E << ccer_shift);
+		timer->SR = ~((TIM_SR_CC1IF | TIM_SR_CC1OF) << (c->channel - 1u));
+		timer->DIER |= ccie;
+	}
+	if ((timer->DIER & (TIM_DIER_CC1IE | TIM_DIER_CC2IE | TIM_DIER_CC3IE | TIM_DIER_CC4IE)) != 0) {
+		timer->DIER |= TIM_DIER_UIE;
+	} else {
+		timer->DIER &= ~TIM_DIER_UIE;
+	}
+	__set_PRIMASK(primask);
+}
+
+static void capture_rx_init(void) {
+	memset(capture_channels, 0, sizeof(capture_channels));
+	capture_channel_count = 0;
+
+	uint32_t tim_clk = apb1_timer_clock();
+	uint32_t prescaler = (tim_clk + (CAPTURE_TICK_HZ / 2u)) / CAPTURE_TICK_HZ;
+	if (prescaler == 0) {
+		prescaler = 1;
+	}
+	capture_tick_hz = tim_clk / prescaler;
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		const GnssUartPins *pins = &kGnssUartPins[i];
+		if (pins->uart_instance != NULL || pins->capture_timer == NULL) {
+			continue;
+		}
+		if (pins->capture_channel < 1 || pins->capture_channel > 4 ||
+		    capture_channel_count >= GNSS_CAPTURE_CHANNEL_MAX) {
+			continue;
+		}
+
+		CaptureRxChannel *c = &capture_channels[capture_channel_count++];
+		c->timer = pins->capture_timer;
+		c->channel = pins->capture_channel;
+		c->slot = (uint8_t)i;
+		c->rx_port = pins->rx_port;
+		c->rx_pin = pins->rx_pin;
+
+		TIM_TypeDef *timer = c->timer;
+		if (timer == TIM3) {
+			__HAL_RCC_TIM3_CLK_ENABLE();
+			HAL_NVIC_SetPriority(TIM3_IRQn, 5, 0);
+			HAL_NVIC_EnableIRQ(TIM3_IRQn);
+		} else if (timer == TIM4) {
+			__HAL_RCC_TIM4_CLK_ENABLE();
+			HAL_NVIC_SetPriority(TIM4_IRQn, 5, 0);
+			HAL_NVIC_EnableIRQ(TIM4_IRQn);
+		}
+
+		if ((timer->CR1 & TIM_CR1_CEN) == 0) {
+			timer->PSC = (uint16_t)(prescaler - 1u);
+			timer->ARR = 0xFFFFu;
+			timer->CR1 = TIM_CR1_URS;
+			timer->EGR = TIM_EGR_UG;
+			timer->SR = 0;
+		}
+
+		/* CCxS = 01 (input on TIx), ICxF = 0011 (8 samples at f_CK_INT) to reject glitches. */
+		volatile uint32_t *ccmr = (c->channel <= 2u) ? &timer->CCMR1 : &timer->CCMR2;
+		uint32_t ccmr_shift = ((uint32_t)(c->channel - 1u) & 1u) * 8u;
+		*ccmr &= ~(0xFFu << ccmr_shift);
+		*ccmr |= (0x01u | (0x3u << 4)) << ccmr_shift;
+
+		capture_rx_arm(c, slot_active(i));
+		timer->CR1 |= TIM_CR1_CEN;
+	}
+}
+
+static void soft_uart_decoder_init(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	memset(d, 0, sizeof(*d));
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		const GnssUartPins *pins = &kGnssUartPins[i];
+		if (pins->uart_instance != NULL || pins->capture_timer != NULL) {
+			continue;
+		}
+		uint32_t bit = sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+		if (bit >= 32u) {
+			continue;
+		}
+		d->slot_for_bit[bit] = (uint8_t)i;
+		if (slot_active(i)) {
+			d->rx_mask |= (1u << bit);
+		}
+	}
+}
+
+static uint32_t bits_for_value(uint32_t value) {
+	uint32_t bits = 1;
+	while (bits < 32u && (value >> bits) != 0) {
+		bits++;
+	}
+	return bits;
+}
+
+/* TIM2 prescaler and period for a sample clock of `tick_hz`. */
+static void tim2_tick_rate(uint32_t tick_hz, SoftUartTiming *t) {
+	uint32_t tim_clk = apb1_timer_clock();
+
+	/*
+	 * Count at the full timer clock where possible: a 1 MHz base quantises the tick period too
+	 * coarsely once the oversampled rate climbs past ~100 kHz.
+	 */
+	if (tick_hz == 0) {
+		tick_hz = 1;
+	}
+	uint32_t prescaler = 1;
+	uint32_t period = (tim_clk + (tick_hz / 2u)) / tick_hz;
+	while (period > 0x10000u && prescaler < 0x10000u) {
+		prescaler++;
+		period = ((tim_clk / prescaler) + (tick_hz / 2u)) / tick_hz;
+	}
+	prescaler -= 1u;
+	if (period == 0) {
+		period = 1;
+	}
+	period -= 1u;
+
+	t->psc = (uint16_t)(prescaler > 0xFFFFu ? 0xFFFFu : prescaler);
+	t->arr = (uint16_t)(period > 0xFFFFu ? 0xFFFFu : period);
+	t->tick_cycles = (uint32_t)(((uint64_t)SystemCoreClock * (t->psc + 1u) * (t->arr + 1u)) / tim_clk);
+}
+
+/* Program the sample clock and transmit dividers from soft_timing_next. Interrupts masked. */
+static void soft_uart_timing_switch(void) {
+	const SoftUartTiming *t = &soft_timing_next;
+	TIM2->PSC = t->psc;
+	TIM2->ARR = t->arr;
+	TIM2->CCR3 = t->arr / 2u;
+	if (TIM2->CNT > TIM2->ARR) {
+		TIM2->CNT = 0;
+	}
+	soft_rate_baud = t->rate_baud;
+	soft_tick_cycles = t->tick_cycles;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		soft_channels[i].tx.ticks_per_bit = t->tx_ticks_per_bit[i];
+	}
+	soft_timing_pending = false;
+}
+
+/*
+ * Derive every software channel's timing from module_baud: the shared sample clock runs at the
+ * fastest software channel's rate times SOFT_UART_OVERSAMPLE and slower channels count more
+ * ticks per bit. With TIM2 stopped the new timing applies at once; otherwise the decode interrupt
+ * switches it in after the next half-buffer, so samples already taken are decoded at the rate
+ * they were taken at.
+ */
+static void soft_uart_timing_apply(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	uint32_t fastest = 0;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (kGnssUartPins[i].uart_instance == NULL && slot_active(i) && module_baud[i] > fastest) {
+			fastest = module_baud[i];
+		}
+	}
+	if (fastest == 0) {
+		fastest = 9600u;
+	}
+	/* A sampled channel being auto-bauded needs the sample clock fast enough for any rate it takes. */
+	if (d->autobaud_request != 0) {
+		fastest = SOFT_UART_AUTOBAUD_BAUD;
+	}
+
+	SoftUartTiming t;
+	memset(&t, 0, sizeof(t));
+	t.rate_baud = fastest;
+	t.autobaud_mask = d->autobaud_request;
+	tim2_tick_rate(fastest * SOFT_UART_OVERSAMPLE, &t);
+
+	uint32_t max_reload = 0;
+	for (uint32_t bit = 0; bit < 32u; bit++) {
+		if ((d->rx_mask & (1u << bit)) == 0) {
+			continue;
+		}
+		uint32_t baud = module_baud[d->slot_for_bit[bit]];
+		uint32_t ticks = ((fastest * SOFT_UART_OVERSAMPLE) + (baud / 2u)) / (baud == 0 ? 1u : baud);
+		if (ticks < 3u) {
+			ticks = 3u;
+		}
+		uint32_t bit_reload = ticks - 1u;
+		uint32_t start_reload = ticks / 2u;
+		if (bit_reload >= (1u << SOFT_UART_PHASE_BITS_MAX)) {
+			bit_reload = (1u << SOFT_UART_PHASE_BITS_MAX) - 1u;
+		}
+		for (uint32_t k = 0; k < SOFT_UART_PHASE_BITS_MAX; k++) {
+			if ((bit_reload & (1u << k)) != 0) {
+				t.bit_reload[k] |= (1u << bit);
+			}
+			if ((start_reload & (1u << k)) != 0) {
+				t.start_reload[k] |= (1u << bit);
+			}
+		}
+		if (bit_reload > max_reload) {
+			max_reload = bit_reload;
+		}
+	}
+	t.phase_bits = bits_for_value(max_reload);
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (kGnssUartPins[i].uart_instance != NULL) {
+			continue;
+		}
+		uint32_t baud = module_baud[i] == 0 ? fastest : module_baud[i];
+		uint32_t div = (fastest + (baud / 2u)) / baud;
+		t.tx_ticks_per_bit[i] = (uint8_t)(div == 0 ? 1u : (div > 255u ? 255u : div));
+	}
+
+	/* Capture channels are decoded in task context: only a channel whose rate changed restarts. */
+	for (size_t i = 0; i < capture_channel_count; i++) {
+		CaptureRxChannel *c = &capture_channels[i];
+		uint32_t baud = module_baud[c->slot];
+		uint32_t bit_ticks_q8 = (uint32_t)(((uint64_t)capture_tick_hz << 8) / (baud == 0 ? 1u : baud));
+		if (bit_ticks_q8 != c->bit_ticks_q8) {
+			c->bit_ticks_q8 = bit_ticks_q8;
+			c->in_frame = false;
+		}
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	soft_timing_next = t;
+	if ((TIM2->CR1 & TIM_CR1_CEN) == 0) {
+		soft_uart_timing_switch();
+		soft_uart_decoder_retime(d);
+	} else {
+		soft_timing_pending = true;
+	}
+	__set_PRIMASK(primask);
+}
+
+static void usart_set_baud(UART_HandleTypeDef *huart, uint32_t baudrate) {
+	USART_TypeDef *instance = huart->Instance;
+	uint32_t pclk = (instance == USART1) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+
+	/* Rewrite BRR only: re-running HAL_UART_Init would drop the DMA and IDLE configuration. */
+	instance->CR1 &= ~USART_CR1_UE;
+	instance->BRR = UART_BRR_SAMPLING16(pclk, baudrate);
+	instance->CR1 |= USART_CR1_UE;
+	huart->Init.BaudRate = baudrate;
+}
+
+bool GnssUart_SetBaud(uint8_t module_index, uint32_t baudrate) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT || baudrate == 0) {
+		return false;
+	}
+	size_t slot = module_index - 1u;
+
+	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
+	if (huart != NULL && huart->Instance != NULL) {
+		usart_set_baud(huart, baudrate);
+		module_baud[slot] = baudrate;
+		/* Bytes still unread were framed at the old rate. */
+		ring_flush(ring_for_module(module_index));
+		return true;
+	}
+
+	if (baudrate > GnssUart_MaxBaud(module_index)) {
+		return false;
+	}
+
+	/* Every software channel must stay within the phase counter range of the shared sample clock. */
+	uint32_t fastest = baudrate;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (i != slot && kGnssUartPins[i].uart_instance == NULL && slot_active(i) && module_baud[i] > fastest) {
+			fastest = module_baud[i];
+		}
+	}
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		uint32_t baud = (i == slot) ? baudrate : module_baud[i];
+		if (kGnssUartPins[i].uart_instance != NULL || !slot_active(i) || baud == 0) {
+			continue;
+		}
+		if ((fastest * SOFT_UART_OVERSAMPLE) / baud >= (1u << SOFT_UART_PHASE_BITS_MAX)) {
+			return false;
+		}
+	}
+
+	module_baud[slot] = baudrate;
+	soft_uart_timing_apply();
+	ring_flush(ring_for_module(module_index));
+	return true;
+}
+
+uint32_t GnssUart_MaxBaud(uint8_t module_index) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return 0;
+	}
+	const GnssUartPins *pins = &kGnssUartPins[module_index - 1u];
+	if (pins->uart_instance == NULL && pins->capture_timer == NULL) {
+		return GNSS_SOFT_UART_MAX_BAUD;
+	}
+	return UINT32_MAX;
+}
+
+uint32_t GnssUart_GetBaud(uint8_t module_index) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return 0;
+	}
+	return module_baud[module_index - 1u];
+}
+
+bool GnssUart_GetStats(uint8_t module_index, GnssUartStats *out) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT || out == NULL) {
+		return false;
+	}
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*out = rx_stats[module_index - 1u];
+	const GnssUartPins *pins = &kGnssUartPins[module_index - 1u];
+	if (pins->uart_instance == NULL && pins->capture_timer == NULL) {
+		out->isr_cycles_max = soft_decode_cycles_max;
+		out->isr_load_permille_max = soft_decode_load_max;
+	}
+	__set_PRIMASK(primask);
+	return true;
+}
+
+/* Rebuild the sampled decoder's channel set from rx_active_mask, then re-gate EXTI and timing. */
+static void soft_uart_rx_mask_apply(void) {
+	SoftUartDecoder *d = &soft_decoder;
+	uint32_t rx_mask = 0;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		const GnssUartPins *pins = &kGnssUartPins[i];
+		if (pins->uart_instance != NULL || pins->capture_timer != NULL || !slot_active(i)) {
+			continue;
+		}
+		uint32_t bit = sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+		if (bit < 32u) {
+			rx_mask |= (1u << bit);
+		}
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	EXTI->IMR &= ~d->exti_mask;
+	d->rx_mask = rx_mask;
+	d->autobaud_mask &= rx_mask;
+	d->autobaud_request &= rx_mask;
+	soft_uart_exti_init();
+	if (!d->sampling) {
+		EXTI->PR = d->exti_mask;
+		EXTI->IMR |= d->exti_mask;
+	}
+	__set_PRIMASK(primask);
+
+	soft_uart_timing_apply();
+}
+
+void GnssUart_SetActiveMask(uint8_t mask) {
+	uint8_t changed = (uint8_t)(mask ^ rx_active_mask);
+	if (changed == 0) {
+		return;
+	}
+	rx_active_mask = mask;
+
+	bool sampled_changed = false;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if ((changed & (1u << i)) == 0) {
+			continue;
+		}
+		if (!slot_active(i)) {
+			autobaud[i].active = false;
+		}
+		if (kGnssUartPins[i].uart_instance == NULL && kGnssUartPins[i].capture_timer == NULL) {
+			sampled_changed = true;
+		}
+	}
+
+	for (size_t i = 0; i < USART_RX_COUNT; i++) {
+		const UsartRxChannel *u = &kUsartRx[i];
+		if ((changed & (1u << u->slot)) == 0) {
+			continue;
+		}
+		if (slot_active(u->slot)) {
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			dma_rx_start(u);
+			u->instance->CR1 |= USART_CR1_RE;
+			__set_PRIMASK(primask);
+		} else {
+			autobaud_exti_stop(u->slot);
+			dma_rx_stop(u);
+		}
+	}
+
+	for (size_t i = 0; i < capture_channel_count; i++) {
+		CaptureRxChannel *c = &capture_channels[i];
+		if ((changed & (1u << c->slot)) != 0) {
+			capture_rx_arm(c, slot_active(c->slot));
+		}
+	}
+
+	if (sampled_changed) {
+		soft_uart_rx_mask_apply();
+	}
+}
+
+uint8_t GnssUart_GetActiveMask(void) {
+	return rx_active_mask;
+}
+
+/*
+ * Nearest standard rate to the measured bit time. The shortest of many quantised pulses read up to
+ * a tick low, which matters at low oversampling, so a rate matches when its bit time is within
+ * one tick plus 10% of the measurement. Standard rates are at least 1.5x apart.
+ */
+static uint32_t autobaud_snap(uint32_t tick_hz, uint32_t width) {
+	if (width == 0 || width == UINT32_MAX) {
+		return 0;
+	}
+	/* Bit times in 1/16 tick; the measurement is taken as half a tick longer. */
+	uint32_t measured_q4 = width * 16u + 8u;
+	uint32_t best = 0;
+	uint32_t best_diff = UINT32_MAX;
+	for (size_t i = 0; i < sizeof(kAutoBaudRates) / sizeof(kAutoBaudRates[0]); i++) {
+		uint32_t rate = kAutoBaudRates[i];
+		uint32_t expected_q4 = (uint32_t)((((uint64_t)tick_hz << 4) + (rate / 2u)) / rate);
+		uint32_t diff = (measured_q4 > expected_q4) ? (measured_q4 - expected_q4) : (expected_q4 - measured_q4);
+		if (diff <= 16u + (expected_q4 / 10u) && diff < best_diff) {
+			best = rate;
+			best_diff = diff;
+		}
+	}
+	return best;
+}
+
+static void autobaud_reset(AutoBaud *ab, uint32_t tick_hz) {
+	ab->start_tick = HAL_GetTick();
+	ab->glitch_width = tick_hz / (AUTOBAUD_MAX_BAUD * 2u);
+	for (size_t i = 0; i < AUTOBAUD_SHORT_PULSES; i++) {
+		ab->short_widths[i] = UINT32_MAX;
+	}
+	ab->pulses = 0;
+	ab->have_edge = false;
+}
+
+/* Time a hardware channel's RX pin from EXTI on both edges; fails if the line is already in use. */
+static bool autobaud_exti_start(size_t slot) {
+	const GnssUartPins *pins = &kGnssUartPins[slot];
+	uint32_t bit = sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+	if (bit >= 32u) {
+		return false;
+	}
+	uint32_t line_bit = 1u << (bit & 15u);
+	if (((soft_decoder.exti_mask | autobaud_exti_mask) & line_bit) != 0) {
+		return false;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	AutoBaud *ab = &autobaud[slot];
+	autobaud_reset(ab, SystemCoreClock);
+	ab->level = (pins->rx_port->IDR & pins->rx_pin) != 0 ? 1u : 0u;
+	uint32_t line = exti_route(bit);
+	autobaud_exti_slot[line] = (uint8_t)slot;
+	EXTI->EMR &= ~line_bit;
+	EXTI->RTSR |= line_bit;
+	EXTI->FTSR |= line_bit;
+	EXTI->PR = line_bit;
+	autobaud_exti_mask |= line_bit;
+	EXTI->IMR |= line_bit;
+	exti_irq_enable(line);
+	__set_PRIMASK(primask);
+	return true;
+}
+
+static void autobaud_exti_stop(size_t slot) {
+	const GnssUartPins *pins = &kGnssUartPins[slot];
+	uint32_t bit = sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+	if (bit >= 32u) {
+		return;
+	}
+	uint32_t line_bit = 1u << (bit & 15u);
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if ((soft_decoder.exti_mask & line_bit) == 0 && autobaud_exti_slot[bit & 15u] == slot) {
+		EXTI->IMR &= ~line_bit;
+		EXTI->RTSR &= ~line_bit;
+		EXTI->FTSR &= ~line_bit;
+		EXTI->PR = line_bit;
+		autobaud_exti_mask &= ~line_bit;
+	}
+	__set_PRIMASK(primask);
+}
+
+bool GnssUart_AutoBaudStart(uint8_t module_index) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return false;
+	}
+	size_t slot = module_index - 1u;
+	const GnssUartPins *pins = &kGnssUartPins[slot];
+	AutoBaud *ab = &autobaud[slot];
+	if (ab->active) {
+		return true;
+	}
+	if (!slot_active(slot)) {
+		return false;
+	}
+
+	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
+	if (huart != NULL && huart->Instance != NULL) {
+		/* Keep line noise at an unknown rate out of the DMA ring while measuring. */
+		huart->Instance->CR1 &= ~USART_CR1_RE;
+		if (!autobaud_exti_start(slot)) {
+			huart->Instance->CR1 |= USART_CR1_RE;
+			return false;
+		}
+		ab->active = true;
+		return true;
+	}
+
+	CaptureRxChannel *capture = capture_for_slot(slot);
+	if (capture != NULL) {
+		autobaud_reset(ab, capture_tick_hz);
+		ab->active = true;
+		return true;
+	}
+
+	SoftUartDecoder *d = &soft_decoder;
+	uint32_t bit = sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+	if (bit >= 32u || (d->rx_mask & (1u << bit)) == 0) {
+		return false;
+	}
+	d->autobaud_request |= (1u << bit);
+	soft_uart_timing_apply();
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	autobaud_reset(ab, SOFT_UART_AUTOBAUD_BAUD * SOFT_UART_OVERSAMPLE);
+	ab->active = true;
+	if (!d->sampling) {
+		soft_uart_sampling_start();
+	}
+	__set_PRIMASK(primask);
+	return true;
+}
+
+bool GnssUart_AutoBaudPoll(uint8_t module_index, uint32_t *baudrate) {
+	if (module_index < 1 || module_index > GNSS_MODULE_COUNT) {
+		return false;
+	}
+	size_t slot = module_index - 1u;
+	const GnssUartPins *pins = &kGnssUartPins[slot];
+	AutoBaud *ab = &autobaud[slot];
+	if (!ab->active) {
+		return false;
+	}
+
+	UART_HandleTypeDef *huart = GnssUart_GetHardwareHandle(module_index);
+	bool hardware = (huart != NULL && huart->Instance != NULL);
+	CaptureRxChannel *capture = capture_for_slot(slot);
+	if (capture != NULL) {
+		capture_rx_poll(capture);
+	}
+
+	if (ab->pulses < GNSS_AUTOBAUD_MIN_PULSES && (HAL_GetTick() - ab->start_tick) < GNSS_AUTOBAUD_TIMEOUT_MS) {
+		return false;
+	}
+
+	uint32_t tick_hz;
+	if (hardware) {
+		tick_hz = SystemCoreClock;
+		autobaud_exti_stop(slot);
+		(void)huart->Instance->SR;
+		(void)huart->Instance->DR;
+		huart->Instance->CR1 |= USART_CR1_RE;
+	} else if (capture != NULL) {
+		tick_hz = capture_tick_hz;
+	} else {
+		tick_hz = soft_rate_baud * SOFT_UART_OVERSAMPLE;
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		uint32_t bit = 1u << sample_bit_for_pin(pins->rx_port, pins->rx_pin);
+		soft_decoder.autobaud_mask &= ~bit;
+		soft_decoder.autobaud_request &= ~bit;
+		__set_PRIMASK(primask);
+		soft_uart_timing_apply();
+	}
+	ab->active = false;
+
+	uint32_t detected = 0;
+	if (ab->pulses >= GNSS_AUTOBAUD_MIN_PULSES) {
+		detected = autobaud_snap(tick_hz, ab->short_widths[AUTOBAUD_SHORT_PULSES / 2u]);
+	}
+	if (baudrate != NULL) {
+		*baudrate = detected;
+	}
+	return true;
+}
+
+void GnssUart_SoftUartInit(uint32_t baudrate) {
+	memset(soft_channels, 0, sizeof(soft_channels));
+	soft_tx_active = 0;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		if (kGnssUartPins[i].uart_instance == NULL) {
+			uint32_t max_baud = GnssUart_MaxBaud((uint8_t)(i + 1u));
+			module_baud[i] = (baudrate > max_baud) ? max_baud : baudrate;
+		}
+	}
+	soft_uart_decoder_init();
+	capture_rx_init();
+
+	__HAL_RCC_TIM2_CLK_ENABLE();
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	TIM2->CR1 &= ~TIM_CR1_CEN;
+	TIM2->DIER = 0;
+	TIM2->CNT = 0;
+	soft_uart_timing_apply();
+	TIM2->EGR = TIM_EGR_UG;
+	TIM2->SR = 0;
+
+	DMA1->IFCR = DMA_IFCR_CGIF1 | (DMA_IFCR_CGIF1 << 4u);
+	sample_dma_start(DMA1_Channel2, GPIOB, soft_samples_b, 0);
+	sample_dma_start(DMA1_Channel1, GPIOA, soft_samples_a, DMA_CCR_HTIE | DMA_CCR_TCIE);
+
+	HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 6, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+	TIM2->DIER = TIM_DIER_UDE | TIM_DIER_CC3DE;
+
+	/*
+	 * Transmit shares the sampling time base: TIM2 update is TRGO, and TIM1 counts it (external
+	 * clock mode 1 on ITR1) to interrupt once per bit at soft_rate_baud, only while busy.
+	 */
+	TIM2->CR2 = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_1;
+	TIM1->CR1 = 0;
+	TIM1->DIER = 0;
+	TIM1->SMCR = TIM_SMCR_TS_0 | TIM_SMCR_SMS;
+	TIM1->PSC = 0;
+	TIM1->ARR = SOFT_UART_OVERSAMPLE - 1u;
+	TIM1->CR1 = TIM_CR1_URS;
+	TIM1->EGR = TIM_EGR_UG;
+	TIM1->SR = 0;
+	TIM1->CR1 |= TIM_CR1_CEN;
+
+	HAL_NVIC_SetPriority(TIM1_UP_IRQn, 4, 0);
+	HAL_NVIC_EnableIRQ(TIM1_UP_IRQn);
+
+	soft_uart_exti_init();
+	if (soft_decoder.rx_mask != 0) {
+		soft_uart_sampling_start();
+	}
+}
+
+static void soft_decode_cycles_note(uint32_t start, uint32_t blocks) {
+	uint32_t cycles = DWT->CYCCNT - start;
+	if (cycles > soft_decode_cycles_max) {
+		soft_decode_cycles_max = cycles;
+	}
+	uint32_t span = blocks * GNSS_SOFT_UART_SAMPLE_BLOCK * soft_tick_cycles;
+	uint32_t load = (span == 0) ? 0 : (cycles * 1000u) / span;
+	if (load > soft_decode_load_max) {
+		soft_decode_load_max = load;
+	}
+}
+
+void GnssUart_SoftDmaIrqHandler(void) {
+	uint32_t start = DWT->CYCCNT;
+	uint32_t flags = DMA1->ISR & (DMA_ISR_HTIF1 | DMA_ISR_TCIF1);
+	DMA1->IFCR = DMA_IFCR_CGIF1;
+
+	/* Channel 1 (GPIOA) lags channel 2 (GPIOB) by half a tick, so both halves are complete. */
+	if ((flags & DMA_ISR_HTIF1) != 0) {
+		soft_uart_decode_block(0);
+	}
+	if ((flags & DMA_ISR_TCIF1) != 0) {
+		soft_uart_decode_block(GNSS_SOFT_UART_SAMPLE_BLOCK);
+	}
+
+	/*
+	 * New timing waits for a boundary: samples from here on are taken at the new rate, and the
+	 * decoder switches reloads when it reaches the first of them.
+	 */
+	SoftUartDecoder *d = &soft_decoder;
+	if (flags != 0 && soft_timing_pending && !d->retime_armed) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		soft_uart_timing_switch();
+		d->retime_at = (uint16_t)(2u * GNSS_SOFT_UART_SAMPLE_BLOCK - DMA1_Channel1->CNDTR);
+		d->retime_armed = true;
+		__set_PRIMASK(primask);
+	}
+
+	/* A whole block without frames on any channel: stop sampling until the next start bit. */
+	if (flags != 0 && d->sampling && d->busy == 0 && d->activity == 0 &&
+	    d->autobaud_request == 0) {
+		soft_uart_sampling_stop(((flags & DMA_ISR_TCIF1) != 0) ? 0 : GNSS_SOFT_UART_SAMPLE_BLOCK);
+	}
+	if (flags != 0) {
+		d->activity = 0;
+		soft_decode_cycles_note(start, (flags == (DMA_ISR_HTIF1 | DMA_ISR_TCIF1)) ? 2u : 1u);
 	}
 }
@@ -67,16 +67,19 @@ static void FusionPrintTask(void *argument)
 		GnssFusionResult r = {0};
 		if (GnssFusion_GetResult(&r) && r.has_fix)
 		{
-			printf("[fusion %s used=%u rej=%u hdop=%u res=%ucm] ",
+			printf("[fusion %s used=%u rej=%u altrej=%u hdop=%u res=%ucm] ",
 			       FusionStatusToString(r.status),
 			       (unsigned)r.used_modules,
 			       (unsigned)r.rejected_modules,
+			       (unsigned)r.alt_rejected_modules,
 			       (unsigned)r.avg_hdop_centi,
 			       (unsigned)r.max_residual_cm);
 			PrintCoordE7("lat", r.lat_e7);
 			printf(" ");
 			PrintCoordE7("lon", r.lon_e7);
-			printf(" alt=%.2fm tick=%lu\r\n", (double)r.alt_cm / 100.0, (unsigned long)r.last_update_tick);
+			printf(" alt=%.2fm vel=%ld,%ldcm/s std=%u/%ucm cep95=%ucm tick=%lu\r\n", (double)r.alt_cm / 100.0,
+			       (long)r.vel_e_cms, (long)r.vel_n_cms, (unsigned)r.std_horizontal_cm, (unsigned)r.std_up_cm,
+			       (unsigned)r.cep95_cm, (unsigned long)r.last_update_tick);
 		}
 		else
 		{
@@ -105,17 +108,52 @@ void SysTick_Handler(void)
 
 void USART1_IRQHandler(void)
 {
-	GnssUart_IrqHandler(USART1);
+	GnssUart_IrqHandler(GNSS_UART_RX_USART1);
 }
 
 void USART2_IRQHandler(void)
 {
-	GnssUart_IrqHandler(USART2);
+	GnssUart_IrqHandler(GNSS_UART_RX_USART2);
 }
 
 void USART3_IRQHandler(void)
 {
-	GnssUart_IrqHandler(USART3);
+	GnssUart_IrqHandler(GNSS_UART_RX_USART3);
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+	GnssUart_SoftDmaIrqHandler();
+}
+
+void DMA1_Channel3_IRQHandler(void)
+{
+	GnssUart_DmaIrqHandler(GNSS_UART_RX_USART3);
+}
+
+void DMA1_Channel5_IRQHandler(void)
+{
+	GnssUart_DmaIrqHandler(GNSS_UART_RX_USART1);
+}
+
+void DMA1_Channel6_IRQHandler(void)
+{
+	GnssUart_DmaIrqHandler(GNSS_UART_RX_USART2);
+}
+
+void TIM1_UP_IRQHandler(void)
+{
+	GnssUart_TimIrqHandler();
+}
+
+void TIM3_IRQHandler(void)
+{
+	GnssUart_CaptureIrqHandler(TIM3);
+}
+
+void TIM4_IRQHandler(void)
+{
+	GnssUart_CaptureIrqHandler(TIM4);
 }
 
 void SPI1_IRQHandler(void)
@@ -128,9 +166,19 @@ void EXTI1_IRQHandler(void)
 	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
 }
 
-void TIM2_IRQHandler(void)
+void EXTI3_IRQHandler(void)
 {
-	GnssUart_TimIrqHandler();
+	GnssUart_ExtiIrqHandler();
+}
+
+void EXTI9_5_IRQHandler(void)
+{
+	GnssUart_ExtiIrqHandler();
+}
+
+void EXTI15_10_IRQHandler(void)
+{
+	GnssUart_ExtiIrqHandler();
 }
 
 int main(void)
@@ -139,7 +187,12 @@ int main(void)
 	SystemClock_Config();
 	MX_GPIO_Init();
 
+	/*
+	 * ATGM336H modules boot at 9600; move the array to 115200 once the tasks are running (sampled
+	 * software channels stop at GNSS_SOFT_UART_MAX_BAUD).
+	 */
 	Gnss_Init(9600);
+	(void)Gnss_RequestBaudrate(115200);
 	GnssFusion_Init();
 	SpiFusion_Init();
 
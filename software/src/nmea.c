@@ -328,3 +328,32 @@ bool Nmea_ParseRmc(const char *sentence, NmeaRmc *out) {
 	*out = parsed;
 	return true;
 }
+
+size_t Nmea_BuildSentence(const char *body, char *out, size_t out_len) {
+	static const char hex[] = "0123456789ABCDEF";
+	if (body == NULL || out == NULL) {
+		return 0;
+	}
+	size_t body_len = strlen(body);
+	/* '$' + body + '*' + 2 hex digits + CR LF + NUL. */
+	if (out_len < body_len + 7u) {
+		return 0;
+	}
+
+	uint8_t checksum = 0;
+	for (size_t i = 0; i < body_len; i++) {
+		checksum ^= (uint8_t)body[i];
+	}
+
+	char *p = out;
+	*p++ = '$';
+	memcpy(p, body, body_len);
+	p += body_len;
+	*p++ = '*';
+	*p++ = hex[(checksum >> 4) & 0x0Fu];
+	*p++ = hex[checksum & 0x0Fu];
+	*p++ = '\r';
+	*p++ = '\n';
+	*p = '\0';
+	return (size_t)(p - out);
+}
@@ -9,7 +9,7 @@
 #include "gnss_fusion.h"
 #include "stm32f1xx_hal.h"
 
-#define SPI_FUSION_MAGIC 0x31464745u /* 'EGF1' little-endian */
+#define SPI_FUSION_MAGIC 0x32464745u /* 'EGF2' little-endian */
 
 static volatile uint8_t tx_buf[SPI_FUSION_PACKET_SIZE];
 static volatile uint8_t tx_index;
@@ -72,6 +72,16 @@ static void build_packet_from_isr(uint8_t out[SPI_FUSION_PACKET_SIZE])
 	out[25] = r.used_modules;
 	out[26] = r.rejected_modules;
 	out[27] = r.has_fix ? 1u : 0u;
+	out[28] = r.alt_rejected_modules;
+	out[29] = r.velocity_modules;
+	put_u16_le(&out[30], r.std_horizontal_cm);
+	put_u16_le(&out[32], r.std_up_cm);
+	put_u16_le(&out[34], r.cep95_cm);
+	put_u32_le(&out[36], r.var_east_cm2);
+	put_u32_le(&out[40], r.var_north_cm2);
+	put_i32_le(&out[44], r.cov_en_cm2);
+	put_i32_le(&out[48], r.vel_e_cms);
+	put_i32_le(&out[52], r.vel_n_cms);
 
 	uint16_t crc = crc16_ccitt(out, SPI_FUSION_PACKET_SIZE - 2u);
 	put_u16_le(&out[SPI_FUSION_PACKET_SIZE - 2u], crc);
@@ -0,0 +1,80 @@
+/*
+ * Host harness for the fusion tests: the module table, tick and RTOS hooks gnss_fusion.c calls,
+ * and the source itself, included so tests can reach its static helpers and state. Include once
+ * per test program.
+ */
+#pragma once
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gnss.h"
+#include "task.h"
+#include "test_check.h"
+
+static GnssModuleState test_modules[GNSS_MODULE_COUNT];
+static uint32_t test_tick;
+
+CoreDebug_Type test_core_debug;
+DWT_Type test_dwt;
+
+const GnssModuleState *Gnss_GetModules(void) {
+	return test_modules;
+}
+
+uint8_t Gnss_GetActiveModules(void) {
+	return 0xFFu;
+}
+
+uint32_t HAL_GetTick(void) {
+	return test_tick;
+}
+
+void vTaskDelay(TickType_t ticks) {
+	(void)ticks;
+}
+
+#include "../src/gnss_fusion.c"
+
+/* Metres per degree of latitude, as the ENU code's 1.1132 cm per 1e-7 degree. */
+#define TEST_M_PER_DEG 111320.0
+
+/* xorshift64*, so runs are repeatable on every host libc. */
+static uint64_t test_rng_state = 0x9E3779B97F4A7C15ull;
+
+static inline double test_uniform(void) {
+	test_rng_state ^= test_rng_state >> 12;
+	test_rng_state ^= test_rng_state << 25;
+	test_rng_state ^= test_rng_state >> 27;
+	return (double)((test_rng_state * 2685821657736338717ull) >> 11) / 9007199254740992.0;
+}
+
+static inline double test_wrap_deg(double lon) {
+	while (lon >= 180.0) {
+		lon -= 360.0;
+	}
+	while (lon < -180.0) {
+		lon += 360.0;
+	}
+	return lon;
+}
+
+/* A module's fix `east_m`/`north_m` from a point, in the module's 1e-7 degree fields. */
+static inline void test_place(GnssModuleState *m, double lat, double lon, double east_m, double north_m, double alt_m) {
+	double fix_lat = lat + north_m / TEST_M_PER_DEG;
+	double fix_lon = test_wrap_deg(lon + east_m / (TEST_M_PER_DEG * cos(fix_lat * M_PI / 180.0)));
+	m->lat_e7 = (int32_t)llround(fix_lat * 1e7);
+	m->lon_e7 = (int32_t)llround(fix_lon * 1e7);
+	if (m->lon_e7 == 1800000000) {
+		m->lon_e7 = -1800000000;
+	}
+	m->alt_cm = (int32_t)llround(alt_m * 100.0);
+}
+
+/* Horizontal distance in cm between two fixes in 1e-7 degrees, across the antimeridian too. */
+static inline double test_distance_cm(double lat_a_e7, double lon_a_e7, double lat_b_e7, double lon_b_e7) {
+	double north = (lat_a_e7 - lat_b_e7) * 1e-7 * TEST_M_PER_DEG;
+	double east = test_wrap_deg((lon_a_e7 - lon_b_e7) * 1e-7) * TEST_M_PER_DEG * cos(lat_b_e7 * 1e-7 * M_PI / 180.0);
+	return hypot(north, east) * 100.0;
+}
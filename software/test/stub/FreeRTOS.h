@@ -0,0 +1,9 @@
+/* Host stand-in: the fusion sources only need the basic FreeRTOS types. */
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
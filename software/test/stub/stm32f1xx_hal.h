@@ -0,0 +1,247 @@
+/*
+ * Host stand-in for the STM32F1 HAL/CMSIS symbols the fusion and receive sources touch. Registers
+ * are plain structs, one instance per peripheral, defined by the harness that needs them.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	volatile uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+	volatile uint32_t SR, DR, BRR, CR1, CR2, CR3, GTPR;
+} USART_TypeDef;
+
+typedef struct {
+	volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3,
+	    CCR4, BDTR, DCR, DMAR;
+} TIM_TypeDef;
+
+typedef struct {
+	volatile uint32_t CCR, CNDTR, CPAR, CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+	volatile uint32_t ISR, IFCR;
+} DMA_TypeDef;
+
+typedef struct {
+	volatile uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR;
+} EXTI_TypeDef;
+
+typedef struct {
+	volatile uint32_t EVCR, MAPR, EXTICR[4], RESERVED0, MAPR2;
+} AFIO_TypeDef;
+
+typedef struct {
+	volatile uint32_t CR, CFGR, CIR, APB2RSTR, APB1RSTR, AHBENR, APB2ENR, APB1ENR, BDCR, CSR;
+} RCC_TypeDef;
+
+extern CoreDebug_Type test_core_debug;
+extern DWT_Type test_dwt;
+extern GPIO_TypeDef test_gpioa, test_gpiob;
+extern USART_TypeDef test_usart1, test_usart2, test_usart3;
+extern TIM_TypeDef test_tim1, test_tim2, test_tim3, test_tim4;
+extern DMA_TypeDef test_dma1;
+extern DMA_Channel_TypeDef test_dma1_channel[7];
+extern EXTI_TypeDef test_exti;
+extern AFIO_TypeDef test_afio;
+extern RCC_TypeDef test_rcc;
+extern uint32_t SystemCoreClock;
+
+#define CoreDebug (&test_core_debug)
+#define DWT (&test_dwt)
+#define GPIOA (&test_gpioa)
+#define GPIOB (&test_gpiob)
+#define USART1 (&test_usart1)
+#define USART2 (&test_usart2)
+#define USART3 (&test_usart3)
+#define TIM1 (&test_tim1)
+#define TIM2 (&test_tim2)
+#define TIM3 (&test_tim3)
+#define TIM4 (&test_tim4)
+#define DMA1 (&test_dma1)
+#define DMA1_Channel1 (&test_dma1_channel[0])
+#define DMA1_Channel2 (&test_dma1_channel[1])
+#define DMA1_Channel3 (&test_dma1_channel[2])
+#define DMA1_Channel4 (&test_dma1_channel[3])
+#define DMA1_Channel5 (&test_dma1_channel[4])
+#define DMA1_Channel6 (&test_dma1_channel[5])
+#define DMA1_Channel7 (&test_dma1_channel[6])
+#define EXTI (&test_exti)
+#define AFIO (&test_afio)
+#define RCC (&test_rcc)
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24)
+#define DWT_CTRL_CYCCNTENA_Msk 1u
+
+typedef enum {
+	EXTI0_IRQn = 6,
+	EXTI1_IRQn = 7,
+	EXTI2_IRQn = 8,
+	EXTI3_IRQn = 9,
+	EXTI4_IRQn = 10,
+	DMA1_Channel1_IRQn = 11,
+	DMA1_Channel2_IRQn = 12,
+	DMA1_Channel3_IRQn = 13,
+	DMA1_Channel4_IRQn = 14,
+	DMA1_Channel5_IRQn = 15,
+	DMA1_Channel6_IRQn = 16,
+	DMA1_Channel7_IRQn = 17,
+	EXTI9_5_IRQn = 23,
+	TIM1_UP_IRQn = 25,
+	TIM2_IRQn = 28,
+	TIM3_IRQn = 29,
+	TIM4_IRQn = 30,
+	USART1_IRQn = 37,
+	USART2_IRQn = 38,
+	USART3_IRQn = 39,
+	EXTI15_10_IRQn = 40,
+} IRQn_Type;
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+typedef struct {
+	uint32_t Pin, Mode, Pull, Speed;
+} GPIO_InitTypeDef;
+
+typedef struct {
+	uint32_t BaudRate, WordLength, StopBits, Parity, Mode, HwFlowCtl, OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+	USART_TypeDef *Instance;
+	UART_InitTypeDef Init;
+} UART_HandleTypeDef;
+
+#define GPIO_PIN_0 0x0001u
+#define GPIO_PIN_1 0x0002u
+#define GPIO_PIN_2 0x0004u
+#define GPIO_PIN_3 0x0008u
+#define GPIO_PIN_4 0x0010u
+#define GPIO_PIN_5 0x0020u
+#define GPIO_PIN_6 0x0040u
+#define GPIO_PIN_7 0x0080u
+#define GPIO_PIN_8 0x0100u
+#define GPIO_PIN_9 0x0200u
+#define GPIO_PIN_10 0x0400u
+#define GPIO_PIN_11 0x0800u
+#define GPIO_PIN_12 0x1000u
+#define GPIO_PIN_13 0x2000u
+#define GPIO_PIN_14 0x4000u
+#define GPIO_PIN_15 0x8000u
+#define GPIO_MODE_INPUT 0u
+#define GPIO_MODE_OUTPUT_PP 1u
+#define GPIO_MODE_AF_PP 2u
+#define GPIO_NOPULL 0u
+#define GPIO_PULLUP 1u
+#define GPIO_SPEED_FREQ_HIGH 3u
+
+#define UART_WORDLENGTH_8B 0u
+#define UART_STOPBITS_1 0u
+#define UART_PARITY_NONE 0u
+#define UART_MODE_TX_RX 0xCu
+#define UART_HWCONTROL_NONE 0u
+#define UART_OVERSAMPLING_16 0u
+#define UART_BRR_SAMPLING16(pclk, baud) ((pclk) / (baud))
+
+#define RCC_CFGR_PPRE1 (7u << 8)
+#define RCC_CFGR_PPRE1_DIV1 0u
+
+#define TIM_CR1_CEN 1u
+#define TIM_CR1_URS 4u
+#define TIM_CR2_MMS (7u << 4)
+#define TIM_CR2_MMS_1 (2u << 4)
+#define TIM_SMCR_SMS 7u
+#define TIM_SMCR_TS_0 (1u << 4)
+#define TIM_DIER_UIE 1u
+#define TIM_DIER_CC1IE 2u
+#define TIM_DIER_CC2IE 4u
+#define TIM_DIER_CC3IE 8u
+#define TIM_DIER_CC4IE 16u
+#define TIM_DIER_UDE (1u << 8)
+#define TIM_DIER_CC3DE (1u << 11)
+#define TIM_SR_UIF 1u
+#define TIM_SR_CC1IF 2u
+#define TIM_SR_CC1OF (1u << 9)
+#define TIM_EGR_UG 1u
+#define TIM_CCER_CC1E 1u
+#define TIM_CCER_CC1P 2u
+
+#define USART_SR_FE 2u
+#define USART_SR_NE 4u
+#define USART_SR_ORE 8u
+#define USART_SR_IDLE 16u
+#define USART_SR_TC 64u
+#define USART_CR1_RE 4u
+#define USART_CR1_IDLEIE 16u
+#define USART_CR1_UE (1u << 13)
+#define USART_CR3_EIE 1u
+#define USART_CR3_DMAR (1u << 6)
+
+#define DMA_CCR_EN 1u
+#define DMA_CCR_TCIE 2u
+#define DMA_CCR_HTIE 4u
+#define DMA_CCR_TEIE 8u
+#define DMA_CCR_CIRC 32u
+#define DMA_CCR_MINC 128u
+#define DMA_CCR_PSIZE_1 (1u << 9)
+#define DMA_CCR_MSIZE_0 (1u << 10)
+#define DMA_CCR_PL_0 (1u << 12)
+#define DMA_CCR_PL_1 (1u << 13)
+#define DMA_ISR_TCIF1 2u
+#define DMA_ISR_HTIF1 4u
+#define DMA_ISR_TEIF1 8u
+#define DMA_IFCR_CGIF1 1u
+
+#define __HAL_RCC_AFIO_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_USART1_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_USART2_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_USART3_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM1_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM3_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM4_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE() ((void)0)
+#define __HAL_AFIO_REMAP_USART1_ENABLE() ((void)0)
+
+/* Single-threaded host: interrupts run only when a test calls a handler. */
+#define __disable_irq() ((void)0)
+#define __DMB() ((void)0)
+
+static inline uint32_t __get_PRIMASK(void) {
+	return 0;
+}
+
+static inline void __set_PRIMASK(uint32_t primask) {
+	(void)primask;
+}
+
+static inline uint32_t __CLZ(uint32_t value) {
+	return (value == 0) ? 32u : (uint32_t)__builtin_clz(value);
+}
+
+uint32_t HAL_GetTick(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *data, uint16_t len, uint32_t timeout);
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub);
+void HAL_NVIC_EnableIRQ(IRQn_Type irq);
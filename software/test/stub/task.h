@@ -0,0 +1,15 @@
+/* Host stand-in: single-threaded, so critical sections are empty. */
+#pragma once
+
+#include "FreeRTOS.h"
+
+#define taskENTER_CRITICAL() \
+	do {                     \
+	} while (0)
+#define taskEXIT_CRITICAL() \
+	do {                    \
+	} while (0)
+#define taskENTER_CRITICAL_FROM_ISR() 0u
+#define taskEXIT_CRITICAL_FROM_ISR(saved) ((void)(saved))
+
+void vTaskDelay(TickType_t ticks);
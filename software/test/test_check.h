@@ -0,0 +1,17 @@
+/* Failure counting shared by the host tests: a failed check prints its location and continues. */
+#pragma once
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define TEST_CHECK(cond, ...)                                 \
+	do {                                                      \
+		if (!(cond)) {                                        \
+			if (test_failures++ < 20) {                       \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+				printf(__VA_ARGS__);                          \
+				printf("\n");                                 \
+			}                                                 \
+		}                                                     \
+	} while (0)
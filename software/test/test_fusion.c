@@ -0,0 +1,177 @@
+/*
+ * compute_fusion() against a double-precision reference of the same selection and weights, over
+ * random scenarios and the edge cases of the integer path: fixes straddling the antimeridian,
+ * latitudes up to 89.9 degrees, and HDOP at and beyond its clamp limits.
+ *
+ * Each scenario starts from a fresh fusion state whose track has already seen every module's
+ * epoch, so the published fix is the epoch mean the track starts from (test_track covers the
+ * filter itself). Inliers sit well inside their gates and outliers far outside, so the used set
+ * is unambiguous and any difference from the reference is arithmetic.
+ *
+ * Error bound per axis: the mean rounds to 0.5e-7 degree (0.56 cm), the track start truncates
+ * to 1 cm in ENU, and the way back rounds to 0.5e-7 degree again, so 2.2 cm per axis and
+ * 3.1 cm horizontally; altitude only rounds once, to 0.5 cm.
+ */
+#include "fusion_harness.h"
+
+#define HORIZONTAL_BOUND_CM 3.1
+#define ALTITUDE_BOUND_CM 0.5
+
+typedef enum {
+	FAMILY_RANDOM = 0,
+	FAMILY_ANTIMERIDIAN,
+	FAMILY_HIGH_LATITUDE,
+	FAMILY_HDOP_LIMITS,
+	FAMILY_COUNT,
+} Family;
+
+static const char *const kFamilyNames[FAMILY_COUNT] = {"random", "antimeridian", "high latitude", "hdop limits"};
+
+/* Raw HDOP values at, inside and beyond the 0.5..50 clamp. */
+static const uint16_t kHdopLimits[] = {1u, 49u, 50u, 51u, 100u, 4999u, 5000u, 5001u, 9999u};
+
+static double reference_weight(uint16_t hdop_centi) {
+	double h = hdop_centi < HDOP_CENTI_MIN ? HDOP_CENTI_MIN : (hdop_centi > HDOP_CENTI_MAX ? HDOP_CENTI_MAX : hdop_centi);
+	return floor(4294967295.0 / (h * h));
+}
+
+static double gate_m(uint16_t hdop_centi) {
+	double h = hdop_centi < HDOP_CENTI_MIN ? HDOP_CENTI_MIN : (hdop_centi > HDOP_CENTI_MAX ? HDOP_CENTI_MAX : hdop_centi);
+	double gate_cm = 2000.0 + 15.0 * h;
+	return (gate_cm < 2500.0 ? 2500.0 : (gate_cm > 15000.0 ? 15000.0 : gate_cm)) / 100.0;
+}
+
+static uint16_t random_hdop(Family family) {
+	if (family == FAMILY_HDOP_LIMITS) {
+		return kHdopLimits[(size_t)(test_uniform() * (sizeof(kHdopLimits) / sizeof(kHdopLimits[0])))];
+	}
+	return (uint16_t)(60u + (uint16_t)(test_uniform() * 300.0));
+}
+
+static void run_scenario(Family family, double *max_h_cm, double *max_alt_cm) {
+	double lat;
+	double lon;
+	switch (family) {
+	case FAMILY_ANTIMERIDIAN:
+		lat = test_uniform() * 140.0 - 70.0;
+		lon = (test_uniform() < 0.5 ? 180.0 : -180.0) + (test_uniform() - 0.5) * 2e-4;
+		break;
+	case FAMILY_HIGH_LATITUDE:
+		lat = (test_uniform() < 0.5 ? 1.0 : -1.0) * (85.0 + test_uniform() * 4.9);
+		lon = test_uniform() * 360.0 - 180.0;
+		break;
+	default:
+		lat = test_uniform() * 160.0 - 80.0;
+		lon = test_uniform() * 360.0 - 180.0;
+		break;
+	}
+	lon = test_wrap_deg(lon);
+	double alt = test_uniform() * 2000.0;
+
+	size_t count = 3u + (size_t)(test_uniform() * (GNSS_MODULE_COUNT - 2u));
+	if (count > GNSS_MODULE_COUNT) {
+		count = GNSS_MODULE_COUNT;
+	}
+	size_t outliers = (size_t)(test_uniform() * (double)((count - 1u) / 2u + 1u));
+
+	GnssFusion_Init();
+	memset(test_modules, 0, sizeof(test_modules));
+	test_tick = 100000u;
+
+	uint16_t hdop[GNSS_MODULE_COUNT];
+	double radius_m = 1e9;
+	for (size_t i = 0; i < count; i++) {
+		hdop[i] = random_hdop(family);
+		if (i >= outliers && 0.3 * gate_m(hdop[i]) < radius_m) {
+			radius_m = 0.3 * gate_m(hdop[i]);
+		}
+	}
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = &test_modules[i];
+		m->module_index = (uint8_t)(i + 1u);
+		if (i >= count) {
+			continue;
+		}
+		m->has_fix = true;
+		m->fix_quality = 1;
+		m->satellites = 8;
+		m->hdop_centi = hdop[i];
+		m->last_fix_tick = test_tick;
+		m->fix_epoch = 1;
+		track.fix_epoch[i] = 1;
+
+		double east_m;
+		double north_m;
+		if (i < outliers) {
+			double bearing = test_uniform() * 2.0 * M_PI;
+			double range = 500.0 + test_uniform() * 1500.0;
+			east_m = range * sin(bearing);
+			north_m = range * cos(bearing);
+		} else {
+			double bearing = test_uniform() * 2.0 * M_PI;
+			double range = radius_m * sqrt(test_uniform());
+			east_m = range * sin(bearing);
+			north_m = range * cos(bearing);
+		}
+		test_place(m, lat, lon, east_m, north_m, alt + (test_uniform() - 0.5) * 10.0);
+	}
+
+	compute_fusion();
+	GnssFusionResult r = latest;
+
+	double sum_w = 0.0;
+	double lat_w = 0.0;
+	double lon_w = 0.0;
+	double alt_w = 0.0;
+	int32_t lon_ref_e7 = test_modules[outliers].lon_e7;
+	for (size_t i = outliers; i < count; i++) {
+		const GnssModuleState *m = &test_modules[i];
+		double w = reference_weight(m->hdop_centi);
+		sum_w += w;
+		lat_w += w * m->lat_e7;
+		lon_w += w * test_wrap_deg((m->lon_e7 - (double)lon_ref_e7) * 1e-7) * 1e7;
+		alt_w += w * m->alt_cm;
+	}
+	double ref_lat_e7 = lat_w / sum_w;
+	double ref_lon_e7 = test_wrap_deg((lon_ref_e7 + lon_w / sum_w) * 1e-7) * 1e7;
+	double ref_alt_cm = alt_w / sum_w;
+
+	TEST_CHECK(r.has_fix, "%s: no fix", kFamilyNames[family]);
+	TEST_CHECK(r.used_modules == count - outliers && r.rejected_modules == outliers,
+	           "%s: used %u rejected %u, expected %zu/%zu", kFamilyNames[family], r.used_modules,
+	           r.rejected_modules, count - outliers, outliers);
+
+	double h_cm = test_distance_cm(r.lat_e7, r.lon_e7, ref_lat_e7, ref_lon_e7);
+	double alt_cm = fabs(r.alt_cm - ref_alt_cm);
+	TEST_CHECK(h_cm <= HORIZONTAL_BOUND_CM, "%s: %.2f cm from reference at %.7f, %.7f", kFamilyNames[family],
+	           h_cm, ref_lat_e7 * 1e-7, ref_lon_e7 * 1e-7);
+	TEST_CHECK(alt_cm <= ALTITUDE_BOUND_CM + 1e-9, "%s: altitude %.2f cm from reference", kFamilyNames[family],
+	           alt_cm);
+	if (h_cm > *max_h_cm) {
+		*max_h_cm = h_cm;
+	}
+	if (alt_cm > *max_alt_cm) {
+		*max_alt_cm = alt_cm;
+	}
+}
+
+int main(void) {
+	static const unsigned kScenarios[FAMILY_COUNT] = {20000u, 5000u, 5000u, 5000u};
+
+	GnssFusion_SetMode(GNSS_FUSION_MODE_GATE);
+	for (int family = 0; family < FAMILY_COUNT; family++) {
+		double max_h_cm = 0.0;
+		double max_alt_cm = 0.0;
+		for (unsigned i = 0; i < kScenarios[family]; i++) {
+			run_scenario((Family)family, &max_h_cm, &max_alt_cm);
+		}
+		printf("test_fusion: %-13s %5u scenarios, max error %.2f cm horizontal, %.2f cm altitude\n",
+		       kFamilyNames[family], kScenarios[family], max_h_cm, max_alt_cm);
+	}
+	if (test_failures != 0) {
+		printf("test_fusion: %d checks failed\n", test_failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * median_i32()'s sorting network against an insertion-sort reference, for every count from 1 to
+ * GNSS_MODULE_COUNT: exhaustive over small value alphabets (ties, INT32_MIN/MAX included), then
+ * random values. The median is the element at count / 2 of the sorted input.
+ */
+#include "fusion_harness.h"
+
+static int32_t reference_median(const int32_t *values, size_t count) {
+	int32_t sorted[GNSS_MODULE_COUNT];
+	for (size_t i = 0; i < count; i++) {
+		int32_t v = values[i];
+		size_t j = i;
+		while (j > 0 && sorted[j - 1] > v) {
+			sorted[j] = sorted[j - 1];
+			j--;
+		}
+		sorted[j] = v;
+	}
+	return sorted[count / 2];
+}
+
+static unsigned long checked;
+
+static void check_values(const int32_t *values, size_t count) {
+	int32_t input[GNSS_MODULE_COUNT];
+	memcpy(input, values, count * sizeof(values[0]));
+	int32_t got = median_i32(input, count);
+	int32_t want = reference_median(values, count);
+	TEST_CHECK(got == want, "count %zu: median %ld, expected %ld", count, (long)got, (long)want);
+	TEST_CHECK(memcmp(input, values, count * sizeof(values[0])) == 0, "count %zu: input modified", count);
+	checked++;
+}
+
+/* Every sequence of `count` values drawn from `alphabet`. */
+static void check_exhaustive(const int32_t *alphabet, size_t symbols, size_t count) {
+	size_t digits[GNSS_MODULE_COUNT] = {0};
+	int32_t values[GNSS_MODULE_COUNT];
+	while (1) {
+		for (size_t i = 0; i < count; i++) {
+			values[i] = alphabet[digits[i]];
+		}
+		check_values(values, count);
+
+		size_t i = 0;
+		while (i < count && ++digits[i] == symbols) {
+			digits[i] = 0;
+			i++;
+		}
+		if (i == count) {
+			return;
+		}
+	}
+}
+
+int main(void) {
+	static const int32_t kExtremes[] = {INT32_MIN, INT32_MIN + 1, -1, 0, 1, INT32_MAX - 1, INT32_MAX};
+	static const int32_t kTies[] = {-5, 7, 7};
+
+	for (size_t count = 1; count <= GNSS_MODULE_COUNT; count++) {
+		check_exhaustive(kExtremes, sizeof(kExtremes) / sizeof(kExtremes[0]), count);
+		check_exhaustive(kTies, sizeof(kTies) / sizeof(kTies[0]), count);
+
+		/* Padding is INT32_MAX, so inputs full of INT32_MAX must still pick the right slot. */
+		int32_t values[GNSS_MODULE_COUNT];
+		for (size_t i = 0; i < count; i++) {
+			values[i] = INT32_MAX;
+		}
+		check_values(values, count);
+		for (size_t i = 0; i < count; i++) {
+			values[i] = INT32_MIN;
+		}
+		check_values(values, count);
+
+		for (unsigned n = 0; n < 100000u; n++) {
+			for (size_t i = 0; i < count; i++) {
+				uint32_t bits = (uint32_t)(test_uniform() * 4294967296.0);
+				/* Mix full-range values with a narrow band so ties stay common. */
+				values[i] = (n & 1u) ? (int32_t)bits : (int32_t)(bits % 5u) - 2;
+			}
+			check_values(values, count);
+		}
+	}
+
+	printf("test_median: %lu inputs, counts 1..%u\n", checked, (unsigned)GNSS_MODULE_COUNT);
+	if (test_failures != 0) {
+		printf("test_median: %d checks failed\n", test_failures);
+		return 1;
+	}
+	return 0;
+}
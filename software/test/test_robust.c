@@ -0,0 +1,161 @@
+/*
+ * The robust fusion modes against a step outlier: seven modules on a 30 cm circle and an eighth
+ * stepped east by 5 m to 200 m, all at HDOP 1.0 (gate threshold 35 m, Huber knee 8.75 m). Each
+ * step starts from a fresh fusion state whose track has already seen the epoch, so the published
+ * fix is the epoch estimate itself.
+ *
+ * Gate mode takes the plain mean inside the gate and drops the outlier beyond it. Huber matches
+ * the mean below its knee and bounds the pull beyond it to knee / 7 however far the outlier goes.
+ * Tukey redescends: the pull shrinks as the outlier moves out, and reaches zero at the threshold.
+ *
+ * The vertical pass runs on its own: a module with a good horizontal fix but a height 40 m off
+ * (threshold 25 m at HDOP 1.0) stays in the position and out of alt_cm, and a module dropped
+ * horizontally never reaches it.
+ */
+#include "fusion_harness.h"
+
+#define LAT0 -33.9
+#define LON0 151.2
+#define INLIERS 7u
+#define HDOP_CENTI 100u
+#define RING_M 0.3
+#define ALT_M 50.0
+/* ENU rounding on the way in and out. */
+#define ROUNDING_CM 2.0
+
+static const double kStepsM[] = {5.0, 15.0, 30.0, 60.0, 200.0};
+#define STEP_COUNT (sizeof(kStepsM) / sizeof(kStepsM[0]))
+
+typedef struct {
+	double shift_cm; /* East of the inliers' centre. */
+	double up_cm;    /* Above the inliers' altitude. */
+	uint8_t used;
+	uint8_t alt_rejected;
+	uint8_t iterations;
+} StepResult;
+
+/* Fuse the inliers and one module `step_m` east of them and `up_m` above. */
+static StepResult fuse_step(GnssFusionMode mode, double step_m, double up_m) {
+	GnssFusion_Init();
+	GnssFusion_SetMode(mode);
+	memset(test_modules, 0, sizeof(test_modules));
+	test_tick = 100000u;
+
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = &test_modules[i];
+		m->module_index = (uint8_t)(i + 1u);
+		m->has_fix = true;
+		m->fix_quality = 1;
+		m->hdop_centi = HDOP_CENTI;
+		m->last_fix_tick = test_tick;
+		m->fix_epoch = 1;
+		track.fix_epoch[i] = 1;
+		if (i < INLIERS) {
+			double angle = 2.0 * M_PI * (double)i / INLIERS;
+			test_place(m, LAT0, LON0, RING_M * sin(angle), RING_M * cos(angle), ALT_M);
+		} else {
+			test_place(m, LAT0, LON0, step_m, 0.0, ALT_M + up_m);
+		}
+	}
+
+	compute_fusion();
+	StepResult s;
+	s.shift_cm = test_wrap_deg(latest.lon_e7 * 1e-7 - LON0) * TEST_M_PER_DEG * cos(LAT0 * M_PI / 180.0) * 100.0;
+	s.up_cm = latest.alt_cm - ALT_M * 100.0;
+	s.used = latest.used_modules;
+	s.alt_rejected = latest.alt_rejected_modules;
+	s.iterations = irls_iterations;
+	return s;
+}
+
+static void check_gate(void) {
+	for (size_t k = 0; k < STEP_COUNT; k++) {
+		StepResult s = fuse_step(GNSS_FUSION_MODE_GATE, kStepsM[k], 0.0);
+		bool inside = kStepsM[k] * 100.0 < gate_threshold_cm(HDOP_CENTI);
+		double want_cm = inside ? kStepsM[k] * 100.0 / (INLIERS + 1u) : 0.0;
+		TEST_CHECK(s.used == (inside ? INLIERS + 1u : INLIERS), "gate %.0f m: used %u", kStepsM[k], s.used);
+		TEST_CHECK(fabs(s.shift_cm - want_cm) <= ROUNDING_CM, "gate %.0f m: shift %.1f cm, expected %.1f",
+		           kStepsM[k], s.shift_cm, want_cm);
+	}
+}
+
+static void check_huber(void) {
+	double knee_cm = gate_threshold_cm(HDOP_CENTI) / HUBER_KNEE_DIV;
+	for (size_t k = 0; k < STEP_COUNT; k++) {
+		StepResult s = fuse_step(GNSS_FUSION_MODE_HUBER, kStepsM[k], 0.0);
+		TEST_CHECK(s.used == INLIERS + 1u, "huber %.0f m: used %u", kStepsM[k], s.used);
+		TEST_CHECK(s.iterations >= 1u && s.iterations <= GNSS_FUSION_IRLS_MAX_ITER, "huber %.0f m: %u passes",
+		           kStepsM[k], s.iterations);
+		if (kStepsM[k] * 100.0 < knee_cm) {
+			double mean_cm = kStepsM[k] * 100.0 / (INLIERS + 1u);
+			TEST_CHECK(fabs(s.shift_cm - mean_cm) <= ROUNDING_CM, "huber %.0f m: shift %.1f cm, mean %.1f",
+			           kStepsM[k], s.shift_cm, mean_cm);
+		} else {
+			TEST_CHECK(s.shift_cm > 0.0 && s.shift_cm <= knee_cm / INLIERS + ROUNDING_CM,
+			           "huber %.0f m: shift %.1f cm beyond the bound %.1f", kStepsM[k], s.shift_cm,
+			           knee_cm / INLIERS);
+		}
+	}
+}
+
+static void check_tukey(void) {
+	double last_cm = 0.0;
+	for (size_t k = 0; k < STEP_COUNT; k++) {
+		StepResult s = fuse_step(GNSS_FUSION_MODE_TUKEY, kStepsM[k], 0.0);
+		bool inside = kStepsM[k] * 100.0 < gate_threshold_cm(HDOP_CENTI);
+		TEST_CHECK(s.used == (inside ? INLIERS + 1u : INLIERS), "tukey %.0f m: used %u", kStepsM[k], s.used);
+		TEST_CHECK(s.shift_cm <= kStepsM[k] * 100.0 / (INLIERS + 1u) + ROUNDING_CM,
+		           "tukey %.0f m: shift %.1f cm above the plain mean", kStepsM[k], s.shift_cm);
+		if (!inside) {
+			TEST_CHECK(fabs(s.shift_cm) <= ROUNDING_CM, "tukey %.0f m: rejected outlier still pulls %.1f cm",
+			           kStepsM[k], s.shift_cm);
+		} else if (k > 0 && kStepsM[k] >= 30.0) {
+			TEST_CHECK(s.shift_cm < last_cm, "tukey %.0f m: pull %.1f cm did not redescend from %.1f", kStepsM[k],
+			           s.shift_cm, last_cm);
+		}
+		last_cm = s.shift_cm;
+	}
+}
+
+static void check_vertical(void) {
+	static const GnssFusionMode kModes[] = {GNSS_FUSION_MODE_GATE, GNSS_FUSION_MODE_HUBER, GNSS_FUSION_MODE_TUKEY};
+	static const char *const kNames[] = {"gate", "huber", "tukey"};
+	double threshold_cm = alt_threshold_cm(HDOP_CENTI);
+
+	for (size_t k = 0; k < sizeof(kModes) / sizeof(kModes[0]); k++) {
+		StepResult s = fuse_step(kModes[k], 0.0, 40.0);
+		TEST_CHECK(s.used == INLIERS + 1u, "%s vertical: used %u horizontally", kNames[k], s.used);
+		if (kModes[k] == GNSS_FUSION_MODE_HUBER) {
+			double bound_cm = threshold_cm / HUBER_KNEE_DIV / INLIERS;
+			TEST_CHECK(s.alt_rejected == 0 && s.up_cm > 0.0 && s.up_cm <= bound_cm + 1.0,
+			           "%s vertical: %u rejected, pulled %.0f cm up, bound %.0f", kNames[k], s.alt_rejected, s.up_cm,
+			           bound_cm);
+		} else {
+			TEST_CHECK(s.alt_rejected == 1u && fabs(s.up_cm) <= 0.5, "%s vertical: %u rejected, pulled %.0f cm up",
+			           kNames[k], s.alt_rejected, s.up_cm);
+		}
+
+		/* Dropped horizontally: its height must not count either way. */
+		s = fuse_step(kModes[k], 200.0, 40.0);
+		TEST_CHECK(s.used == INLIERS + (kModes[k] == GNSS_FUSION_MODE_HUBER ? 1u : 0u), "%s far: used %u",
+		           kNames[k], s.used);
+		if (kModes[k] != GNSS_FUSION_MODE_HUBER) {
+			TEST_CHECK(s.alt_rejected == 0 && fabs(s.up_cm) <= 0.5, "%s far: %u rejected, pulled %.0f cm up",
+			           kNames[k], s.alt_rejected, s.up_cm);
+		}
+	}
+}
+
+int main(void) {
+	check_gate();
+	check_huber();
+	check_tukey();
+	check_vertical();
+	printf("test_robust: gate, Huber and Tukey against an outlier stepped %.0f..%.0f m\n", kStepsM[0],
+	       kStepsM[STEP_COUNT - 1u]);
+	if (test_failures != 0) {
+		printf("test_robust: %d checks failed\n", test_failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * The sampled software UART through the simulated TIM2/DMA/EXTI path: sentences arriving while
+ * sampling is parked; start bits that land between the end of an idle half-buffer and the decode
+ * interrupt that parks sampling (11 bit times at 115200 with 4x oversampling), which must not be
+ * lost; and rate changes and auto-baud on one channel while another streams. Also the timer-capture
+ * channel's edge queue across an idle gap longer than one queue entry can encode.
+ */
+#include "uart_harness.h"
+
+#define TEST_BAUD 115200u
+#define TEST_LATENCY 44u /* Ticks from the half/full flag to the park decision. */
+
+static size_t drain(uint8_t module_index, uint8_t *dst, size_t max_len) {
+	size_t total = 0;
+	size_t n;
+	while (total < max_len && (n = GnssUart_ReadBytes(module_index, dst + total, max_len - total)) != 0) {
+		total += n;
+	}
+	return total;
+}
+
+static void check_parks(const char *what) {
+	test_uart_run(4u * TEST_SAMPLE_RING + TEST_LATENCY);
+	TEST_CHECK(!soft_decoder.sampling, "%s: sampling still running after the line went idle", what);
+	TEST_CHECK((TIM2->CR1 & TIM_CR1_CEN) == 0, "%s: TIM2 still counting", what);
+}
+
+static void check_received(uint8_t module_index, const uint8_t *want, size_t len, const char *what) {
+	uint8_t got[64];
+	size_t n = drain(module_index, got, sizeof(got));
+	TEST_CHECK(n == len && memcmp(got, want, len) == 0, "%s: module %u received %zu bytes, expected %zu", what,
+	           module_index, n, len);
+}
+
+/* Sentences on two channels arriving after sampling has parked wake it, decode and park again. */
+static void check_wake(void) {
+	static const uint8_t kSentence[] = "$GNGGA,1*5C\r\n";
+	size_t len = sizeof(kSentence) - 1u;
+
+	test_uart_reset(TEST_BAUD, TEST_LATENCY);
+	check_parks("initial");
+	test_uart_send(5, TEST_BAUD, 17.0, kSentence, len);
+	test_uart_send(7, TEST_BAUD, 230.5, kSentence, len);
+	test_uart_run(2u * 10u * 4u * len + 2u * TEST_SAMPLE_RING);
+	check_received(5, kSentence, len, "wake");
+	check_received(7, kSentence, len, "wake");
+	check_parks("wake");
+}
+
+/*
+ * Sampling starts at init and the first half-buffer is idle, so its decode interrupt parks TIM2.
+ * A frame starting `offset` ticks after that half ended is already on the line when the decision
+ * is made, up to TEST_LATENCY ticks later. 0xFF has no falling edge after its start bit, so a
+ * parked sampler would miss it entirely and then take the next start bit mid-stream.
+ */
+static void check_start_before_park(uint32_t offset) {
+	static const uint8_t kBytes[] = {0xFFu, 'A', 'B', '\n'};
+	char what[32];
+	snprintf(what, sizeof(what), "offset %u", (unsigned)offset);
+
+	test_uart_reset(TEST_BAUD, TEST_LATENCY);
+	test_uart_send(5, TEST_BAUD, (double)(GNSS_SOFT_UART_SAMPLE_BLOCK + offset), kBytes, sizeof(kBytes));
+	test_uart_run(GNSS_SOFT_UART_SAMPLE_BLOCK + TEST_LATENCY + 10u * 4u * sizeof(kBytes) + 2u * TEST_SAMPLE_RING);
+	check_received(5, kBytes, sizeof(kBytes), what);
+	check_parks(what);
+}
+
+static void fill_stream(uint8_t *bytes, size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		bytes[i] = (uint8_t)(0x30u + (i * 7u) % 64u);
+	}
+}
+
+/*
+ * A rate change on one channel that leaves the sample clock alone must not touch the others:
+ * module 5 streams at 115200 while module 6 is switched to 57600 and back.
+ */
+static void check_retime_other_channel(void) {
+	uint8_t stream[48];
+	fill_stream(stream, sizeof(stream));
+
+	test_uart_reset(TEST_BAUD, TEST_LATENCY);
+	test_uart_send(5, TEST_BAUD, 300.0, stream, sizeof(stream));
+	test_uart_run(300u + 10u * 4u * 12u + 7u);
+	TEST_CHECK(GnssUart_SetBaud(6, 57600u), "retime: SetBaud(6, 57600) failed");
+	test_uart_run(10u * 4u * 12u + 3u);
+	TEST_CHECK(GnssUart_SetBaud(6, TEST_BAUD), "retime: SetBaud(6, %u) failed", (unsigned)TEST_BAUD);
+	test_uart_run(10u * 4u * sizeof(stream) + 2u * TEST_SAMPLE_RING);
+	check_received(5, stream, sizeof(stream), "retime other channel");
+}
+
+/*
+ * A rate change that moves the sample clock: module 7 streams at 9600 when module 5 goes to 19200
+ * and TIM2 doubles its rate. Samples already taken at the old rate must be decoded with the old
+ * bit time, and the frame in flight carried over to the new one.
+ */
+static void check_retime_sample_clock(void) {
+	static const uint8_t kFast[] = "fast\n";
+	uint8_t stream[24];
+	fill_stream(stream, sizeof(stream));
+
+	for (uint32_t at = 0; at < 2u * TEST_SAMPLE_RING; at += 13u) {
+		char what[48];
+		snprintf(what, sizeof(what), "retime sample clock at +%u", (unsigned)at);
+		test_uart_reset(9600u, TEST_LATENCY);
+		test_uart_send(7, 9600u, 100.0, stream, sizeof(stream));
+		test_uart_run(100u + 10u * 4u * 6u + at);
+		TEST_CHECK(GnssUart_SetBaud(5, 19200u), "%s: SetBaud(5, 19200) failed", what);
+		test_uart_run(2u * 10u * 4u * sizeof(stream) + 4u * TEST_SAMPLE_RING);
+
+		check_received(7, stream, sizeof(stream), what);
+		TEST_CHECK(rx_stats[6].framing_errors == 0, "%s: %lu framing errors on module 7", what,
+		           (unsigned long)rx_stats[6].framing_errors);
+
+		test_uart_send(5, 19200u, 5.0, kFast, sizeof(kFast) - 1u);
+		test_uart_run(8u * 10u * 2u * (sizeof(kFast) - 1u) + 2u * TEST_SAMPLE_RING);
+		check_received(5, kFast, sizeof(kFast) - 1u, what);
+	}
+}
+
+/*
+ * Auto-baud on a sampled channel raises the sample clock to the auto-baud rate while another
+ * channel streams at 9600: the stream is carried over, and the rate is measured at the new clock.
+ */
+static void check_autobaud_retime(void) {
+	static const uint8_t kSentence[] = "$GNRMC,,V*21\r\n";
+	uint8_t stream[24];
+	fill_stream(stream, sizeof(stream));
+
+	test_uart_reset(9600u, TEST_LATENCY);
+	test_uart_send(7, 9600u, 100.0, stream, sizeof(stream));
+	test_uart_run(100u + 10u * 4u * 5u + 21u);
+	TEST_CHECK(GnssUart_AutoBaudStart(6), "autobaud: start failed");
+	test_uart_send(6, 38400u, 300.0, kSentence, sizeof(kSentence) - 1u);
+
+	uint32_t detected = 0;
+	bool done = false;
+	for (uint32_t i = 0; i < 200u && !done; i++) {
+		test_uart_run(TEST_SAMPLE_RING);
+		done = GnssUart_AutoBaudPoll(6, &detected);
+	}
+	TEST_CHECK(done && detected == 38400u, "autobaud: detected %lu baud, expected 38400", (unsigned long)detected);
+	test_uart_run(12u * 10u * 4u * sizeof(stream) + 4u * TEST_SAMPLE_RING);
+	check_received(7, stream, sizeof(stream), "autobaud");
+	check_parks("autobaud");
+}
+
+/* Module 4 captures on TIM4 ch4 (PB9): set the capture clock, in 8 MHz ticks since arming. */
+static void capture_set_now(uint32_t time) {
+	capture_for_slot(3)->overflow = (uint16_t)(time >> 16);
+	TIM4->CNT = time & 0xFFFFu;
+	TIM4->SR = 0;
+}
+
+/* One 8N1 frame on module 4 at `baud`, as the capture interrupts it raises, starting at `start`. */
+static void capture_send(uint32_t start, uint32_t baud, uint8_t byte) {
+	uint32_t level = 1u;
+	for (uint32_t bit = 0; bit < 10u; bit++) {
+		uint32_t want = (bit == 0) ? 0u : (bit == 9u ? 1u : (byte >> (bit - 1u)) & 1u);
+		if (want == level) {
+			continue;
+		}
+		level = want;
+		uint32_t time = start + (uint32_t)((uint64_t)bit * CAPTURE_TICK_HZ / baud);
+		capture_set_now(time);
+		TIM4->CCR4 = time & 0xFFFFu;
+		GPIOB->IDR = level ? (GPIOB->IDR | GPIO_PIN_9) : (GPIOB->IDR & ~(uint32_t)GPIO_PIN_9);
+		TIM4->SR = TIM_SR_CC1IF << 3;
+		GnssUart_CaptureIrqHandler(TIM4);
+		TIM4->SR = 0;
+	}
+}
+
+/*
+ * Edges are queued as 15-bit deltas, so a two-second idle gap saturates its entry. A frame still in
+ * flight at the next poll, after the gap, must be timed against the real clock: 0xF0 ends in four
+ * high data bits and the stop bit, which have no edges and are resolved against "now".
+ */
+static void check_capture_long_idle(void) {
+	uint8_t got[4];
+	uint32_t bit = CAPTURE_TICK_HZ / TEST_BAUD;
+
+	test_uart_reset(TEST_BAUD, TEST_LATENCY);
+	capture_send(1000u, TEST_BAUD, 'A');
+	capture_set_now(1000u + 12u * bit);
+	size_t n = drain(4, got, sizeof(got));
+	TEST_CHECK(n == 1 && got[0] == 'A', "capture: first byte, %zu bytes", n);
+
+	uint32_t start = 1000u + 2u * CAPTURE_TICK_HZ;
+	capture_send(start, TEST_BAUD, 0xF0u);
+	capture_set_now(start + 3u * bit);
+	n = drain(4, got, sizeof(got));
+	TEST_CHECK(n == 0, "capture: %zu bytes before the frame ended", n);
+	capture_set_now(start + 12u * bit);
+	n = drain(4, got, sizeof(got));
+	TEST_CHECK(n == 1 && got[0] == 0xF0u, "capture: byte after the idle gap, %zu bytes", n);
+	TEST_CHECK(rx_stats[3].framing_errors == 0 && rx_stats[3].noise_errors == 0, "capture: line errors");
+}
+
+int main(void) {
+	check_capture_long_idle();
+	check_wake();
+	check_retime_other_channel();
+	check_retime_sample_clock();
+	check_autobaud_retime();
+	for (uint32_t offset = 0; offset <= TEST_LATENCY + 8u; offset++) {
+		check_start_before_park(offset);
+	}
+
+	printf("test_soft_uart: %u baud, start bits 0..%u ticks after an idle half-buffer\n", (unsigned)TEST_BAUD,
+	       (unsigned)(TEST_LATENCY + 8u));
+	if (test_failures != 0) {
+		printf("test_soft_uart: %d checks failed\n", test_failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * The Kalman track over a simulated drive: 8 modules with 2.5 m noise per axis at 1 Hz, fused
+ * every GNSS_FUSION_PERIOD_MS, at rest and at 20 m/s. Each epoch reaches the fusion as a GGA and,
+ * a pass later, the RMC of the same epoch, which must not be applied to the track or the bias
+ * estimate a second time. Also: a stale fix propagated to the fusion instant by its RMC velocity,
+ * and the per-module bias average converging on a module with a constant offset.
+ */
+#include "fusion_harness.h"
+
+#define LAT0 48.1
+#define LON0 11.5
+#define NOISE_M 2.5
+#define RMS_BOUND_M 1.0
+
+/* Noise per axis, and a constant east/north/up error of each module on top, in metres. */
+static double noise_m = NOISE_M;
+static double module_offset_m[GNSS_MODULE_COUNT][3];
+
+static inline double gauss(void) {
+	double u = test_uniform() + 1e-12;
+	double v = test_uniform();
+	return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static void report_epoch(double east_m, double north_m, uint32_t epoch) {
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = &test_modules[i];
+		m->module_index = (uint8_t)(i + 1u);
+		m->has_fix = true;
+		m->fix_quality = 1;
+		m->hdop_centi = 90;
+		m->last_fix_tick = test_tick;
+		m->fix_epoch = epoch;
+		const double *offset = module_offset_m[i];
+		test_place(m, LAT0, LON0, east_m + offset[0] + gauss() * noise_m, north_m + offset[1] + gauss() * noise_m,
+		           500.0 + offset[2]);
+	}
+}
+
+/*
+ * The RMC of the current epoch, as gnss.c takes it: same position and epoch, so last_fix_tick stays
+ * at the GGA's, plus the ground velocity, stamped with the epoch's tick.
+ */
+static void report_rmc_repeat(double east_ms, double north_ms) {
+	double course_deg = atan2(east_ms, north_ms) * 180.0 / M_PI;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = &test_modules[i];
+		m->speed_centi_ms = (uint16_t)lround(hypot(east_ms, north_ms) * 100.0);
+		long course_centi = lround((course_deg < 0.0 ? course_deg + 360.0 : course_deg) * 100.0);
+		m->course_centi_deg = (uint16_t)(course_centi % 36000);
+		m->last_velocity_tick = m->last_fix_tick;
+	}
+}
+
+static double drive(double speed_ms) {
+	GnssFusion_Init();
+	memset(test_modules, 0, sizeof(test_modules));
+	test_tick = 1000u;
+
+	double se = 0.0;
+	double sn = 0.0;
+	unsigned samples = 0;
+	uint32_t epoch = 0;
+	for (unsigned step = 0; step < 3000u; step++) {
+		double t = test_tick / 1000.0;
+		double east_m = speed_ms * t;
+		double north_m = 0.3 * speed_ms * t;
+		unsigned phase = step % (1000u / GNSS_FUSION_PERIOD_MS);
+		if (phase == 0) {
+			report_epoch(east_m, north_m, ++epoch);
+		} else if (phase == 1) {
+			report_rmc_repeat(speed_ms, 0.3 * speed_ms);
+		}
+
+		compute_fusion();
+		if (step > 100u && latest.has_fix) {
+			double lat = LAT0 + north_m / TEST_M_PER_DEG;
+			double fe = test_wrap_deg(latest.lon_e7 * 1e-7 - LON0) * TEST_M_PER_DEG * cos(lat * M_PI / 180.0);
+			double fn = (latest.lat_e7 * 1e-7 - LAT0) * TEST_M_PER_DEG;
+			se += (fe - east_m) * (fe - east_m);
+			sn += (fn - north_m) * (fn - north_m);
+			samples++;
+		}
+		test_tick += GNSS_FUSION_PERIOD_MS;
+	}
+
+	double rms_e = sqrt(se / samples);
+	double rms_n = sqrt(sn / samples);
+	printf("test_track: %4.1f m/s, RMS error %.2f m east, %.2f m north\n", speed_ms, rms_e, rms_n);
+	TEST_CHECK(samples > 2800u, "%.1f m/s: only %u fused passes", speed_ms, samples);
+	/* The published accuracy keeps one fix's common-mode error (3 m x HDOP 0.9) however many agree. */
+	TEST_CHECK(latest.std_horizontal_cm >= 270u && latest.std_horizontal_cm < 400u,
+	           "%.1f m/s: std_horizontal_cm %u outside the common-mode floor", speed_ms, latest.std_horizontal_cm);
+	TEST_CHECK(rms_e < RMS_BOUND_M && rms_n < RMS_BOUND_M, "%.1f m/s: RMS %.2f/%.2f m over %.1f m", speed_ms, rms_e,
+	           rms_n, RMS_BOUND_M);
+	return rms_e > rms_n ? rms_e : rms_n;
+}
+
+/* A repeated epoch leaves the covariance to the prediction and the biases untouched. */
+static void check_epoch_applied_once(void) {
+	GnssFusion_Init();
+	memset(test_modules, 0, sizeof(test_modules));
+	test_tick = 1000u;
+	uint32_t epoch = 0;
+	for (unsigned i = 0; i < 20u; i++) {
+		report_epoch(0.0, 0.0, ++epoch);
+		compute_fusion();
+		test_tick += 1000u;
+	}
+
+	report_epoch(0.0, 0.0, ++epoch);
+	compute_fusion();
+	int64_t p00_fresh = track.p00;
+	ModuleBias bias_fresh[GNSS_MODULE_COUNT];
+	memcpy(bias_fresh, module_bias, sizeof(bias_fresh));
+
+	test_tick += GNSS_FUSION_PERIOD_MS;
+	report_rmc_repeat(0.0, 0.0);
+	compute_fusion();
+	TEST_CHECK(track.p00 >= p00_fresh, "repeated epoch shrank p00 from %lld to %lld", (long long)p00_fresh,
+	           (long long)track.p00);
+	TEST_CHECK(memcmp(bias_fresh, module_bias, sizeof(bias_fresh)) == 0, "repeated epoch stepped the bias");
+
+	int64_t p00_repeat = track.p00;
+	test_tick += GNSS_FUSION_PERIOD_MS;
+	report_epoch(0.0, 0.0, ++epoch);
+	compute_fusion();
+	TEST_CHECK(track.p00 < p00_repeat, "new epoch did not update the track");
+}
+
+/*
+ * Modules report at different instants: at 20 m/s east, seven fixes are fresh and the eighth is
+ * 600 ms old. Propagated by its RMC velocity it lands on the others rather than 12 m behind, which
+ * would pull the mean back by 1.5 m. Noise-free, and the track has seen the epoch already, so the
+ * published fix is the epoch mean.
+ */
+static void check_stale_fix_aligned(void) {
+	const double speed_ms = 20.0;
+	const uint32_t stale_ms = 600u;
+
+	GnssFusion_Init();
+	memset(test_modules, 0, sizeof(test_modules));
+	test_tick = 10000u;
+	for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+		GnssModuleState *m = &test_modules[i];
+		m->module_index = (uint8_t)(i + 1u);
+		m->has_fix = true;
+		m->fix_quality = 1;
+		m->hdop_centi = 90;
+		m->fix_epoch = 1;
+		m->last_fix_tick = (i == GNSS_MODULE_COUNT - 1u) ? test_tick - stale_ms : test_tick;
+		test_place(m, LAT0, LON0, speed_ms * m->last_fix_tick / 1000.0, 0.0, 500.0);
+		track.fix_epoch[i] = 1;
+	}
+	report_rmc_repeat(speed_ms, 0.0);
+
+	compute_fusion();
+	double fe = test_wrap_deg(latest.lon_e7 * 1e-7 - LON0) * TEST_M_PER_DEG * cos(LAT0 * M_PI / 180.0);
+	double err_cm = fabs(fe - speed_ms * test_tick / 1000.0) * 100.0;
+	TEST_CHECK(latest.used_modules == GNSS_MODULE_COUNT, "stale fix: used %u modules", latest.used_modules);
+	TEST_CHECK(err_cm < 10.0, "stale fix: fused %.1f cm from the true position", err_cm);
+	TEST_CHECK(latest.max_residual_cm < 20u, "stale fix: residual %u cm after alignment", latest.max_residual_cm);
+	TEST_CHECK(alignment.max_age_ms == stale_ms && alignment.max_cm >= 1195u && alignment.max_cm <= 1205u,
+	           "stale fix: aligned %lu ms by %lu cm", (unsigned long)alignment.max_age_ms,
+	           (unsigned long)alignment.max_cm);
+}
+
+/*
+ * One module reads 3 m east, 2 m south and 4 m high of the rest. Only offsets between modules are
+ * observable and the biases stay zero-mean, so it should learn 7/8 of that and the other seven
+ * -1/8. The average moves 1/128 of the way per epoch: about two thirds there after 128 epochs,
+ * and within the noise after 1000, 0.5 m / sqrt(255) or 3 cm per axis against a 10 cm bound.
+ */
+static void check_bias_converges(void) {
+	static const double kOffsetM[3] = {3.0, -2.0, 4.0};
+	const size_t biased = 2;
+	const unsigned epochs = 1000u;
+	const unsigned early = 1u << GNSS_FUSION_BIAS_SHIFT;
+
+	GnssFusion_Init();
+	memset(test_modules, 0, sizeof(test_modules));
+	memcpy(module_offset_m[biased], kOffsetM, sizeof(kOffsetM));
+	noise_m = 0.5;
+	test_tick = 1000u;
+	for (unsigned epoch = 1; epoch <= epochs; epoch++) {
+		report_epoch(0.0, 0.0, epoch);
+		compute_fusion();
+		test_tick += 1000u;
+
+		if (epoch != early && epoch != epochs) {
+			continue;
+		}
+		for (size_t axis = 0; axis < 3; axis++) {
+			for (size_t i = 0; i < GNSS_MODULE_COUNT; i++) {
+				double want_cm = kOffsetM[axis] * 100.0 * ((i == biased) ? 7.0 : -1.0) / 8.0;
+				double got_cm = bias_cm(&module_bias[i], axis);
+				if (epoch == early) {
+					if (i == biased) {
+						TEST_CHECK(got_cm / want_cm > 0.4 && got_cm / want_cm < 0.85,
+						           "bias after %u epochs: axis %zu at %.0f cm of %.0f", epoch, axis, got_cm, want_cm);
+					}
+				} else {
+					TEST_CHECK(fabs(got_cm - want_cm) < 10.0, "bias: module %zu axis %zu learned %.0f cm, expected %.0f",
+					           i + 1u, axis, got_cm, want_cm);
+				}
+			}
+		}
+	}
+	memset(module_offset_m, 0, sizeof(module_offset_m));
+	noise_m = NOISE_M;
+}
+
+int main(void) {
+	drive(0.0);
+	drive(20.0);
+	check_epoch_applied_once();
+	check_stale_fix_aligned();
+	check_bias_converges();
+	if (test_failures != 0) {
+		printf("test_track: %d checks failed\n", test_failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Host harness for the receive tests: the peripheral registers and HAL hooks gnss_uart.c touches,
+ * the source itself (included so tests can reach its static state), and a model of the sampled
+ * software UART. Time advances in TIM2 ticks at TIM2's current rate. Each tick drives the scheduled
+ * frames onto the RX pins (a falling edge raises its EXTI line); while TIM2 runs, the sampling DMA
+ * stores GPIOA/GPIOB IDR and raises the half/full transfer flags; the decode interrupt runs
+ * `test_dma_latency` ticks after its flag, standing in for interrupt latency plus the decode itself.
+ * Include once per test.
+ */
+#pragma once
+
+#include <string.h>
+
+#include "gnss_uart.h"
+#include "test_check.h"
+
+CoreDebug_Type test_core_debug;
+DWT_Type test_dwt;
+GPIO_TypeDef test_gpioa, test_gpiob;
+USART_TypeDef test_usart1, test_usart2, test_usart3;
+TIM_TypeDef test_tim1, test_tim2, test_tim3, test_tim4;
+DMA_TypeDef test_dma1;
+DMA_Channel_TypeDef test_dma1_channel[7];
+EXTI_TypeDef test_exti;
+AFIO_TypeDef test_afio;
+RCC_TypeDef test_rcc;
+uint32_t SystemCoreClock = 72000000u;
+
+static uint32_t test_tick;
+
+uint32_t HAL_GetTick(void) {
+	return test_tick;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+	return 36000000u;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+	return 72000000u;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) {
+	(void)port;
+	(void)init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) {
+	port->ODR = (state == GPIO_PIN_SET) ? (port->ODR | pin) : (port->ODR & ~(uint32_t)pin);
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+	(void)huart;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *data, uint16_t len, uint32_t timeout) {
+	(void)huart;
+	(void)data;
+	(void)len;
+	(void)timeout;
+	return HAL_OK;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub) {
+	(void)irq;
+	(void)preempt;
+	(void)sub;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type irq) {
+	(void)irq;
+}
+
+#include "../src/gnss_uart.c"
+
+#define TEST_FRAMES_MAX 64u
+#define TEST_SAMPLE_RING (2u * GNSS_SOFT_UART_SAMPLE_BLOCK)
+
+/* 8N1 frames scheduled on one software channel's RX pin, start times in seconds. */
+typedef struct {
+	uint32_t baud;
+	size_t count;
+	double start[TEST_FRAMES_MAX];
+	uint8_t byte[TEST_FRAMES_MAX];
+} TestLine;
+
+static TestLine test_lines[GNSS_MODULE_COUNT];
+static uint64_t test_ticks;
+static double test_time;
+static uint32_t test_dma_latency;
+static uint64_t test_dma_due;
+static bool test_dma_pending;
+
+static double test_tick_hz(void) {
+	return 72000000.0 / ((TIM2->PSC + 1.0) * (TIM2->ARR + 1.0));
+}
+
+/* Fresh peripherals and receive state, every software channel at `baud`, all lines idle high. */
+static inline void test_uart_reset(uint32_t baud, uint32_t dma_latency) {
+	memset(&test_gpioa, 0, sizeof(test_gpioa));
+	memset(&test_gpiob, 0, sizeof(test_gpiob));
+	memset(&test_tim1, 0, sizeof(test_tim1));
+	memset(&test_tim2, 0, sizeof(test_tim2));
+	memset(&test_tim3, 0, sizeof(test_tim3));
+	memset(&test_tim4, 0, sizeof(test_tim4));
+	memset(&test_dma1, 0, sizeof(test_dma1));
+	memset(test_dma1_channel, 0, sizeof(test_dma1_channel));
+	memset(&test_exti, 0, sizeof(test_exti));
+	memset(test_lines, 0, sizeof(test_lines));
+	memset(rx_stats, 0, sizeof(rx_stats));
+	test_rcc.CFGR = 4u << 8; /* APB1 = HCLK / 2, so the APB1 timers run at 72 MHz. */
+	test_gpioa.IDR = 0xFFFFu;
+	test_gpiob.IDR = 0xFFFFu;
+	test_ticks = 0;
+	test_time = 0.0;
+	test_tick = 0;
+	test_dma_latency = dma_latency;
+	test_dma_pending = false;
+	rx_active_mask = 0xFFu;
+
+	GnssUart_GpioInit();
+	GnssUart_SoftUartInit(baud);
+}
+
+/*
+ * Queue `len` bytes back to back on module `module_index`, the first start bit `delay` ticks (at
+ * the current sample rate) from now. A channel carries one baud rate at a time.
+ */
+static inline void test_uart_send(uint8_t module_index, uint32_t baud, double delay, const uint8_t *data, size_t len) {
+	TestLine *line = &test_lines[module_index - 1u];
+	line->baud = baud;
+	double start = test_time + delay / test_tick_hz();
+	for (size_t i = 0; i < len && line->count < TEST_FRAMES_MAX; i++) {
+		line->start[line->count] = start + (double)i * 10.0 / baud;
+		line->byte[line->count] = data[i];
+		line->count++;
+	}
+}
+
+static bool test_line_level(const TestLine *line, double t) {
+	for (size_t i = 0; i < line->count; i++) {
+		double bit = (t - line->start[i]) * line->baud;
+		if (bit < 0.0 || bit >= 10.0) {
+			continue;
+		}
+		if (bit < 1.0) {
+			return false;
+		}
+		if (bit < 9.0) {
+			return ((line->byte[i] >> (int)(bit - 1.0)) & 1u) != 0;
+		}
+		return true;
+	}
+	return true;
+}
+
+static void test_drive_pins(void) {
+	for (size_t slot = 0; slot < GNSS_MODULE_COUNT; slot++) {
+		const GnssUartPins *pins = &kGnssUartPins[slot];
+		if (test_lines[slot].count == 0) {
+			continue;
+		}
+		bool was_high = (pins->rx_port->IDR & pins->rx_pin) != 0;
+		bool high = test_line_level(&test_lines[slot], test_time);
+		pins->rx_port->IDR = high ? (pins->rx_port->IDR | pins->rx_pin) : (pins->rx_port->IDR & ~(uint32_t)pins->rx_pin);
+
+		uint32_t line_bit = pins->rx_pin;
+		if (was_high && !high && (EXTI->FTSR & line_bit) != 0) {
+			EXTI->PR |= line_bit;
+			if ((EXTI->IMR & line_bit) != 0) {
+				GnssUart_ExtiIrqHandler();
+			}
+		}
+	}
+}
+
+/* One sample tick: TIM2 update and CC3 each trigger a DMA transfer into the ping-pong buffers. */
+static void test_sample_dma(void) {
+	DMA_Channel_TypeDef *a = DMA1_Channel1;
+	DMA_Channel_TypeDef *b = DMA1_Channel2;
+	size_t pos = TEST_SAMPLE_RING - a->CNDTR;
+	soft_samples_b[pos] = (uint16_t)GPIOB->IDR;
+	soft_samples_a[pos] = (uint16_t)GPIOA->IDR;
+	a->CNDTR = (a->CNDTR == 1u) ? TEST_SAMPLE_RING : a->CNDTR - 1u;
+	b->CNDTR = (b->CNDTR == 1u) ? TEST_SAMPLE_RING : b->CNDTR - 1u;
+
+	uint32_t flag = 0;
+	if (pos + 1u == GNSS_SOFT_UART_SAMPLE_BLOCK) {
+		flag = DMA_ISR_HTIF1;
+	} else if (pos + 1u == TEST_SAMPLE_RING) {
+		flag = DMA_ISR_TCIF1;
+	}
+	if (flag != 0) {
+		DMA1->ISR |= flag;
+		if (!test_dma_pending) {
+			test_dma_pending = true;
+			test_dma_due = test_ticks + test_dma_latency;
+		}
+	}
+}
+
+static inline void test_uart_step(void) {
+	test_drive_pins();
+	if ((TIM2->CR1 & TIM_CR1_CEN) != 0) {
+		test_sample_dma();
+	}
+	if (test_dma_pending && test_ticks >= test_dma_due) {
+		test_dma_pending = false;
+		GnssUart_SoftDmaIrqHandler();
+		DMA1->ISR = 0;
+	}
+	test_ticks++;
+	test_time += 1.0 / test_tick_hz();
+	test_tick = (uint32_t)(test_time * 1000.0);
+}
+
+static inline void test_uart_run(uint64_t ticks) {
+	for (uint64_t i = 0; i < ticks; i++) {
+		test_uart_step();
+	}
+}